@@ -0,0 +1,100 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+using namespace std;
+
+
+
+// Corpus file: captured int32 arrays for offline training and replay. Native-endian, like the raw key files.
+//   header   "SRTCORP1"
+//   record   uint32 keys, uint8 encoding, uint8 source length, source bytes, uint64 payload bytes, payload
+//   index    uint64 offset of every record
+//   trailer  uint64 index offset, uint64 record count, "SRTCIDX1"
+// Payloads are raw keys or zigzag varints of the deltas between neighbours (whichever is smaller). A file whose
+// writer died before the trailer is still readable: the records are length-prefixed and are walked instead.
+
+enum CorpusEncoding {
+    CORPUS_RAW = 0,           // keys * 4 bytes
+    CORPUS_DELTA_VARINT = 1   // LEB128 of zigzag(key[i] - key[i-1]), key[-1] = 0; 1 byte per key on sorted dense data
+};
+
+
+
+class CorpusWriter {  // Appends records, writes the index on close()
+private:
+    ofstream file;
+    vector<uint64_t> offsets;
+    uint64_t position;
+    bool compress;
+    string error;
+
+public:
+    CorpusWriter();
+    
+    ~CorpusWriter();  // close() if still open
+    
+    bool open(const string& path, bool deltaVarint = true);  // Create or truncate path; deltaVarint allows the compressed encoding
+    
+    bool append(const int* keys, long long n, const string& source);  // One record; source names where it came from (at most 255 bytes)
+    
+    bool close();  // Write index and trailer; false on any write error
+    
+    bool isOpen() const;
+    
+    int getRecordCount() const;
+    
+    const string& getError() const;
+};
+
+
+
+class CorpusReader {  // Maps a corpus read-only; records decode on demand, so a replay streams through the file
+private:
+    const unsigned char* mapping;
+    size_t bytes;
+    vector<uint64_t> offsets;
+    string error;
+    
+    bool walkRecords();  // Rebuild the index from the length prefixes when the trailer is missing
+    
+    CorpusReader(const CorpusReader&);
+    CorpusReader& operator=(const CorpusReader&);
+
+public:
+    CorpusReader();
+    
+    ~CorpusReader();
+    
+    bool open(const string& path);  // mmap and load the index
+    
+    void close();
+    
+    int getRecordCount() const;
+    
+    long long getKeyCount(int index) const;  // Keys in record index (-1 if out of range)
+    
+    string getSource(int index) const;  // Source recorded with the keys
+    
+    bool read(int index, vector<int>& keys) const;  // Decode record index into keys
+    
+    const string& getError() const;
+};
+
+
+
+// Capture hook: while active, the predictor-driven int32 entry points (mappedSort, externalSort runs, and the
+// key/value and argsort overloads that take a predictor) append each array to the corpus before sorting it.
+bool startSortCapture(const string& corpusFile, bool deltaVarint = true);  // Open the capture corpus (replaces an active one)
+
+bool stopSortCapture();  // Close the corpus and write its index; false if any capture failed to write
+
+bool sortCaptureActive();  // Cheap check, so entry points only gather keys when someone is listening
+
+void captureSortInput(const int* keys, long long n, const string& source);  // Append one array (no-op when inactive); thread-safe
+
+#endif
@@ -2,18 +2,60 @@
 #define DATASET_H
 
 #include <vector>
+#include <string>
+#include <memory>
+#include "knn_predictor.h"
+#include "sorting_algorithms.h"
+#include "random_stream.h"
 
 using namespace std;
 
-vector<int> generateRandom(int n);  // Generate random array (range: 1-10000)
+// Seeded generators: the same (seed, parameters) give bit-identical arrays on every run, any core count
+vector<int> generateRandom(int n, uint64_t seed);  // Generate random array (range: 1-10000)
 
-vector<int> generateNearlySorted(int n, int swaps);  // Generate sorted array with random swaps
+vector<int> generateNearlySorted(int n, int swaps, uint64_t seed);  // Generate sorted array with random swaps
 
 vector<int> generateReversed(int n);  // Generate reversed array [n, n-1, ..., 1]
 
-vector<int> generateFewUnique(int n, int uniqueCount);  // Generate array with limited unique values
+vector<int> generateFewUnique(int n, int uniqueCount, uint64_t seed);  // Generate array with limited unique values
 
-vector<int> generateLargeRandom(int n);  // Generate large random array (range: 1-100000)
+vector<int> generateLargeRandom(int n, uint64_t seed);  // Generate large random array (range: 1-100000)
+
+vector<int> generateRandom(int n);  // Unseeded overloads draw freshSeed() on every call
+
+vector<int> generateNearlySorted(int n, int swaps);
+
+vector<int> generateFewUnique(int n, int uniqueCount);
+
+vector<int> generateLargeRandom(int n);
+
+// Production-shaped workloads, all seeded like the generators above
+
+vector<int> generateZipf(int n, int distinctKeys, double exponent, uint64_t seed);  // Key k in [1, distinctKeys] with probability ~ 1/k^exponent (1 is hottest)
+
+vector<int> generateSawtooth(int n, int teeth, uint64_t seed);  // Ascending ramps 1, 2, ..., of random lengths around n / teeth
+
+vector<int> generateOrganPipe(int n, int pipes, uint64_t seed);  // Segments that rise to their middle and fall back
+
+vector<int> generateSortedRuns(int n, int runs, uint64_t seed);  // Concatenated independently sorted runs of random keys
+
+vector<int> generateAppendedTail(int n, double tailFraction, uint64_t seed);  // Sorted log timestamps plus an unsorted tail of recent ones
+
+vector<int> generateSortedWithOutliers(int n, double outlierFraction, uint64_t seed);  // Sorted keys with a fraction overwritten at random
+
+typedef vector<int> (*WorkloadGenerator)(int n, double parameter, uint64_t seed);
+
+struct Workload {  // A dataset shape the training generator and accuracy test sample from
+    string label;            // Dataset type in training data ("Zipf", "Sawtooth", ...)
+    WorkloadGenerator generate;
+    const char* parameter;   // What the shape parameter controls
+    double minParameter;     // Samplers draw the parameter log-uniformly from [minParameter, maxParameter]
+    double maxParameter;
+};
+
+const vector<Workload>& getWorkloads();  // Every registered workload, in display order (the five classic types are separate)
+
+const Workload* findWorkload(const string& label);  // Look up by label (nullptr if unknown)
 
 int getDatasetSize(vector<int>& arr);  // Return array size
 
@@ -21,5 +63,141 @@ double calculateSortedness(vector<int>& arr);  // Calculate sortedness percentag
 
 double calculateUniqueRatio(vector<int>& arr);  // Calculate ratio of unique elements (0.0-1.0)
 
+double calculateSortedness(const int* data, int n);  // Sortedness of a raw buffer, e.g. a file mapping
+
+double calculateUniqueRatio(const int* data, int n);  // Unique ratio of a raw buffer (estimateUniqueRatio at the default error)
+
+const double UNIQUE_DEFAULT_ERROR = 0.05;  // Relative standard error of the unique ratio features use (k = 402)
+
+double exactUniqueRatio(const int* data, int n);  // Exact, via an open-addressing hash set (8 bytes per slot, 2n slots)
+
+double estimateUniqueRatio(const int* data, int n, double relativeError);  // KMV distinct-count sketch in O(1/relativeError^2) memory; exact for n <= 65536
+
+double sampledInversionRatio(const int* data, int n, int sampleSize);  // Inversions among sampleSize strided keys over their pair count
+
+Features extractFeatures(vector<int>& arr);  // All features, including shape, from one fused pass
+
+Features extractFeatures(const int* data, int n);  // Sortedness, unique ratio estimate, runs, range in one vectorized read
+
+const int SAMPLED_FEATURE_MIN_SIZE = 1 << 20;  // From here on a linear feature pass is a noticeable share of the sort
+
+// Estimates of every feature from a sample that grows only until its 95% margins are tight, flagged estimated with
+// the margins (see dataset.cpp); small n gets extractFeatures().
+// The probe positions come from a Xoshiro256 seeded with seed; without one, the seed is a fingerprint of n and a few
+// keys, so one input always gets the same features while different inputs of one size are probed in different places.
+Features sampleFeatures(const int* data, int n, uint64_t seed);
+
+Features sampleFeatures(const int* data, int n);
+
+double sampleUniqueRatio(const int* data, int n, int sampleSize);  // Unique ratio of a strided sample (bounded memory)
+
+
+
+// Starts dense: while every key lies in one window of 2^16 values, keys go straight into a flag per value
+// and nothing is hashed. The first key outside the window moves the flagged values into the hash set.
+class DistinctSketch {  // KMV distinct-count sketch: the k smallest distinct key hashes, in a hash set of up to 2k
+public:
+    explicit DistinctSketch(double relativeError);  // k = 1 / relativeError^2 + 2, capped at 2^20
+    
+    bool dense() const;  // Keys so far fit the dense window: feed keys to insertKeys(), no hashes needed
+    
+    void insertKeys(const int* keys, int count);  // Flag keys while dense, hash them (and leave dense) otherwise
+    
+    unsigned limit() const;  // Hashes above this cannot change the sketch; filter them before insert()
+    
+    void insert(const unsigned* hashes, int count);  // Add key hashes (simdHashAtMost / simdScanBlock output); ends dense mode
+    
+    const unsigned* slots() const;  // The hash table, passed to the scans so hashes already held are not emitted again
+    
+    unsigned slotMask() const;  // Home slot of hash h is h & slotMask()
+    
+    void merge(const DistinctSketch& other);  // Union with a sketch of other keys, built for the same error
+    
+    double estimateRatio(long long n) const;  // Distinct keys over n; exact while fewer than k distinct keys were seen
+    
+private:
+    vector<unsigned> table;
+    int sketchSize;
+    int capacity;
+    bool emptySeen;  // The one hash the table cannot hold; only possible before the first shrink
+    bool shrunk;
+    int stored;
+    unsigned limitValue;
+    bool denseMode;
+    unsigned denseBase;               // Key value of denseSeen[0], set by the first key
+    vector<unsigned char> denseSeen;  // One flag per value of the window while dense
+    
+    vector<unsigned> heldHashes() const;
+    
+    vector<int> denseKeys() const;  // The distinct keys flagged so far
+    
+    void leaveDense();  // Hash the flagged keys into the table
+    
+    void shrink();
+};
+
+
+
+// Features of keys that arrive in chunks, ready when the last chunk lands without another pass. Sortedness,
+// runs and range are exact, the pairs across chunk seams included; the unique ratio comes from a KMV sketch
+// and the inversion ratio from a uniform sample of keys kept with their positions. Accumulators filled by
+// parallel producers merge in the order their keys are to be concatenated; each producer passes its own stream
+// (its chunk index, say), since accumulators on one stream draw the same priorities and the merged sample would
+// favour the same offsets in every chunk.
+struct ScanState;
+
+class FeatureAccumulator {
+public:
+    explicit FeatureAccumulator(double relativeError = UNIQUE_DEFAULT_ERROR, int stream = 0);
+    
+    FeatureAccumulator(const FeatureAccumulator& other);
+    
+    FeatureAccumulator& operator=(const FeatureAccumulator& other);
+    
+    ~FeatureAccumulator();
+    
+    void append(const int* data, int n);  // Keys that follow everything seen so far
+    
+    void append(const vector<int>& chunk);
+    
+    void merge(const FeatureAccumulator& later);  // Take in an accumulator whose keys follow this one's
+    
+    long long size() const;  // Keys seen
+    
+    Features features() const;  // The fields extractFeatures() fills; size must fit in an int
+    
+private:
+    struct SampledKey {  // Reservoir entry: the sample is the keys with the smallest random priorities
+        double priority;
+        long long position;
+        int key;
+        
+        bool operator<(const SampledKey& other) const {
+            return priority < other.priority;
+        }
+    };
+    
+    unique_ptr<ScanState> scan;  // Behind a pointer: the scan kernels and their state are internal to dataset.cpp
+    DistinctSketch sketch;
+    long long count;
+    int firstKey;
+    int lastKey;
+    vector<SampledKey> reservoir;  // Max-heap on priority
+    long long nextSample;          // Position of the next key to enter a full reservoir
+    Xoshiro256 gen;                // Priorities and skips; jumped once per stream
+    
+    double randomUnit();  // Uniform in (0, 1)
+    
+    void scheduleNextSample();  // Skip the keys whose priority would not beat the reservoir's largest
+};
+
+// The same features for other key types (long long, float, double, string), ordered by keyLess()
+
+template <class Key>
+double calculateSortedness(const Key* data, int n);  // Ordered adjacent pairs (0-100%)
+
+template <class Key>
+double sampleUniqueRatio(const Key* data, int n, int sampleSize);  // Unique ratio of a strided sample
+
 #endif
 
@@ -0,0 +1,37 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <string>
+#include <map>
+#include "knn_predictor.h"
+
+using namespace std;
+
+
+
+struct ExternalSortStats {  // I/O volume and per-phase timing of one external sort
+    long long elements;
+    long long bytesRead;        // All reads: input chunks plus every merge pass over the runs
+    long long bytesWritten;     // All writes: sorted runs, intermediate runs and the output
+    int runCount;               // Sorted runs produced by the run phase
+    int mergePasses;            // 1 unless the runs exceeded the merge fan-in
+    double runPhaseMs;          // Read chunks, extract features, sort, write runs
+    double featureMs;           //   of which feature extraction
+    double sortMs;              //   of which in-memory sorting
+    double mergePhaseMs;        // k-way merge of the runs into the output
+    map<string, int> algorithmRuns;  // Predicted label -> number of chunks sorted with it
+    string error;               // Why externalSort returned false
+    
+    ExternalSortStats() : elements(0), bytesRead(0), bytesWritten(0), runCount(0), mergePasses(0),
+                          runPhaseMs(0), featureMs(0), sortMs(0), mergePhaseMs(0) {}
+};
+
+
+
+// Sort a raw binary file of native-endian int32 keys that may be larger than memory.
+// Run phase: read chunks that fit in memoryBytes, let the predictor pick a kernel per chunk,
+// write each sorted chunk to tempDir. Merge phase: loser-tree k-way merge with large buffers.
+bool externalSort(const string& inputFile, const string& outputFile, size_t memoryBytes,
+                  const string& tempDir, KNNPredictor& predictor, ExternalSortStats& stats);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef KEY_TRAITS_H
+#define KEY_TRAITS_H
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+using namespace std;
+
+
+
+// Order-preserving unsigned image of a key, for radix sorting and hashing.
+// Signed integers flip the sign bit. IEEE floats use the total-order transform: negative values
+// have every bit flipped, non-negative ones only the sign bit, so -inf < -0.0 < +0.0 < +inf and
+// NaNs land at the ends by sign. Comparison sorts use the same order through keyLess().
+
+template <class Key> struct KeyTraits;
+
+template <> struct KeyTraits<int> {
+    typedef uint32_t Bits;
+    static Bits orderedBits(int key) { return (uint32_t)key ^ 0x80000000u; }
+};
+
+template <> struct KeyTraits<long long> {
+    typedef uint64_t Bits;
+    static Bits orderedBits(long long key) { return (uint64_t)key ^ 0x8000000000000000ull; }
+};
+
+template <> struct KeyTraits<float> {
+    typedef uint32_t Bits;
+    static Bits orderedBits(float key) {
+        uint32_t bits;
+        memcpy(&bits, &key, sizeof(bits));
+        return bits ^ ((bits >> 31) ? 0xFFFFFFFFu : 0x80000000u);
+    }
+};
+
+template <> struct KeyTraits<double> {
+    typedef uint64_t Bits;
+    static Bits orderedBits(double key) {
+        uint64_t bits;
+        memcpy(&bits, &key, sizeof(bits));
+        return bits ^ ((bits >> 63) ? 0xFFFFFFFFFFFFFFFFull : 0x8000000000000000ull);
+    }
+};
+
+
+
+template <class Key>
+inline bool keyLess(const Key& a, const Key& b) {  // Integers and strings: the natural order
+    return a < b;
+}
+
+template <>
+inline bool keyLess<float>(const float& a, const float& b) {  // Total order, so NaN and -0.0 sort deterministically
+    return KeyTraits<float>::orderedBits(a) < KeyTraits<float>::orderedBits(b);
+}
+
+template <>
+inline bool keyLess<double>(const double& a, const double& b) {
+    return KeyTraits<double>::orderedBits(a) < KeyTraits<double>::orderedBits(b);
+}
+
+template <class Key>
+struct KeyLess {  // keyLess() as a functor, for ordered containers
+    bool operator()(const Key& a, const Key& b) const { return keyLess(a, b); }
+};
+
+#endif
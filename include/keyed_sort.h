@@ -0,0 +1,237 @@
+#ifndef KEYED_SORT_H
+#define KEYED_SORT_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include "key_traits.h"
+
+using namespace std;
+
+
+
+// Comparison and radix engines written once over a key projection, shared by typed_sort.cpp
+// (the element is the key) and record_sort.cpp (the element carries its key in .key).
+// A projection is a functor with a Key typedef whose operator() returns an element's key;
+// every engine orders by keyLess() on that key. Internal: included by those two files only.
+
+const int KEYED_RUN_SIZE = 32;          // Merge runs built with insertion sort
+const int KEYED_INSERTION_CUTOFF = 16;  // Introsort partitions finished with insertion sort
+const int KEYED_RADIX_BITS = 8;
+const int KEYED_RADIX_BUCKETS = 1 << KEYED_RADIX_BITS;
+
+template <class Element>
+struct IdentityKey {  // Plain keys
+    typedef Element Key;
+    const Element& operator()(const Element& element) const { return element; }
+};
+
+template <class Record>
+struct RecordKey {  // Key/value records; the payload never takes part in the order
+    typedef int Key;
+    const int& operator()(const Record& record) const { return record.key; }
+};
+
+
+
+template <class Element, class Project, class Counter>
+void keyedInsertionSort(Element* data, int left, int right, Project key, Counter& counter) {  // Stable insertion sort on data[left..right]
+    for (int i = left + 1; i <= right; i++) {
+        Element item = move(data[i]);
+        int j = i - 1;
+        
+        while (j >= left) {
+            counter.compare();
+            if (keyLess(key(item), key(data[j]))) {
+                data[j + 1] = move(data[j]);
+                counter.move();
+                j--;
+            } else {
+                break;
+            }
+        }
+        data[j + 1] = move(item);
+        counter.move();
+    }
+}
+
+
+
+template <class Element, class Project, class Counter>
+void keyedMergeSort(Element* data, int n, Project key, Counter& counter) {  // Stable bottom-up merge sort with one scratch buffer
+    for (long long left = 0; left < n; left += KEYED_RUN_SIZE) {
+        keyedInsertionSort(data, (int)left, (int)min(left + KEYED_RUN_SIZE, (long long)n) - 1, key, counter);
+    }
+    if (n <= KEYED_RUN_SIZE) {
+        return;
+    }
+    
+    vector<Element> buffer(n);
+    Element* src = data;
+    Element* dst = buffer.data();
+    for (long long width = KEYED_RUN_SIZE; width < n; width *= 2) {  // 64-bit: 2 * width passes 2^31 near INT_MAX
+        for (long long left = 0; left < n; left += 2 * width) {
+            int mid = (int)min(left + width, (long long)n);
+            int right = (int)min(left + 2 * width, (long long)n);
+            int i = (int)left, j = mid, k = (int)left;
+            
+            // Left run wins ties, so equal keys keep their order
+            while (i < mid && j < right) {
+                counter.compare();
+                if (!keyLess(key(src[j]), key(src[i]))) dst[k++] = move(src[i++]);
+                else dst[k++] = move(src[j++]);
+            }
+            while (i < mid) dst[k++] = move(src[i++]);
+            while (j < right) dst[k++] = move(src[j++]);
+            counter.move(right - left);
+        }
+        swap(src, dst);
+    }
+    
+    if (src != data) {
+        move(src, src + n, data);
+        counter.move(n);
+    }
+}
+
+
+
+template <class Element, class Project, class Counter>
+void keyedRadixSort(Element* data, int n, Project key, Counter& counter) {  // Stable LSD radix sort on the key's order-preserving bit image
+    typedef KeyTraits<typename Project::Key> Traits;
+    typedef typename Traits::Bits Bits;
+    const int passes = sizeof(Bits) * 8 / KEYED_RADIX_BITS;
+    
+    vector<int> counts(passes * KEYED_RADIX_BUCKETS, 0);
+    for (int i = 0; i < n; i++) {
+        Bits bits = Traits::orderedBits(key(data[i]));
+        for (int pass = 0; pass < passes; pass++) {
+            counts[pass * KEYED_RADIX_BUCKETS + ((bits >> (pass * KEYED_RADIX_BITS)) & (KEYED_RADIX_BUCKETS - 1))]++;
+        }
+    }
+    
+    vector<Element> buffer;
+    Element* src = data;
+    Element* dst = nullptr;
+    for (int pass = 0; pass < passes; pass++) {
+        int shift = pass * KEYED_RADIX_BITS;
+        int* count = &counts[pass * KEYED_RADIX_BUCKETS];
+        
+        // Constant digit (the high bytes of small int64s, shared float exponents): nothing would move
+        Bits firstDigit = (Traits::orderedBits(key(src[0])) >> shift) & (KEYED_RADIX_BUCKETS - 1);
+        if (count[firstDigit] == n) {
+            continue;
+        }
+        if (buffer.empty()) {
+            buffer.resize(n);
+            dst = buffer.data();
+        }
+        
+        int offset = 0;
+        for (int b = 0; b < KEYED_RADIX_BUCKETS; b++) {
+            int c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+        for (int i = 0; i < n; i++) {
+            Bits digit = (Traits::orderedBits(key(src[i])) >> shift) & (KEYED_RADIX_BUCKETS - 1);
+            dst[count[digit]++] = src[i];
+        }
+        counter.move(n);
+        swap(src, dst);
+    }
+    
+    if (src != data) {
+        copy(src, src + n, data);
+        counter.move(n);
+    }
+}
+
+
+
+template <class Element, class Project, class Counter>
+void keyedSiftDown(Element* data, int root, int size, Project key, Counter& counter) {  // Max-heap sift under keyLess
+    while (true) {
+        int child = 2 * root + 1;
+        if (child >= size) break;
+        if (child + 1 < size) {
+            counter.compare();
+            if (keyLess(key(data[child]), key(data[child + 1]))) child++;
+        }
+        counter.compare();
+        if (!keyLess(key(data[root]), key(data[child]))) break;
+        swap(data[root], data[child]);
+        counter.move(2);
+        root = child;
+    }
+}
+
+template <class Element, class Project, class Counter>
+void keyedSortThree(Element* data, int a, int b, int c, Project key, Counter& counter) {  // Order keys at a <= b <= c
+    counter.compare();
+    if (keyLess(key(data[b]), key(data[a]))) {
+        swap(data[a], data[b]);
+        counter.move(2);
+    }
+    counter.compare();
+    if (keyLess(key(data[c]), key(data[b]))) {
+        swap(data[b], data[c]);
+        counter.move(2);
+        counter.compare();
+        if (keyLess(key(data[b]), key(data[a]))) {
+            swap(data[a], data[b]);
+            counter.move(2);
+        }
+    }
+}
+
+template <class Element, class Project, class Counter>
+void keyedIntroSortLoop(Element* data, int low, int high, int depthLimit, Project key, Counter& counter) {  // Unstable introsort under keyLess
+    while (high - low + 1 > KEYED_INSERTION_CUTOFF) {
+        if (depthLimit == 0) {
+            Element* heap = data + low;
+            int size = high - low + 1;
+            for (int root = size / 2 - 1; root >= 0; root--) {
+                keyedSiftDown(heap, root, size, key, counter);
+            }
+            for (int end = size - 1; end > 0; end--) {
+                swap(heap[0], heap[end]);
+                counter.move(2);
+                keyedSiftDown(heap, 0, end, key, counter);
+            }
+            return;
+        }
+        depthLimit--;
+        
+        // Median of three to data[high], then Lomuto partition; the pivot stays put until the final swap
+        int mid = low + (high - low) / 2;
+        keyedSortThree(data, low, mid, high, key, counter);
+        swap(data[mid], data[high]);
+        counter.move(2);
+        const Element& pivot = data[high];
+        int i = low - 1;
+        for (int j = low; j < high; j++) {
+            counter.compare();
+            if (keyLess(key(data[j]), key(pivot))) {
+                i++;
+                swap(data[i], data[j]);
+                counter.move(2);
+            }
+        }
+        int pi = i + 1;
+        swap(data[pi], data[high]);
+        counter.move(2);
+        
+        if (pi - low < high - pi) {
+            keyedIntroSortLoop(data, low, pi - 1, depthLimit, key, counter);
+            low = pi + 1;
+        } else {
+            keyedIntroSortLoop(data, pi + 1, high, depthLimit, key, counter);
+            high = pi - 1;
+        }
+    }
+    
+    keyedInsertionSort(data, low, high, key, counter);
+}
+
+#endif
@@ -9,13 +9,43 @@ using namespace std;
 
 
 
+enum KeyType {  // Key type of the dataset; engines differ per type, so each type gets its own samples
+    KEY_INT32,
+    KEY_INT64,
+    KEY_FLOAT,
+    KEY_DOUBLE,
+    KEY_STRING
+};
+
+const char* getKeyTypeName(KeyType type);  // "int32", "int64", "float", "double", "string"
+
+bool parseKeyType(const string& name, KeyType& type);  // Inverse of getKeyTypeName
+
+
+
 struct Features {  // Dataset characteristics for k-NN classification
     int size;           // Number of elements in this dataset
     double sortedness;  // How sorted the data is (0-100%)
     double uniqueRatio; // Ratio of unique elements (0.0-1.0)
+    KeyType keyType;    // predict() only lets samples of the same key type vote
+    
+    // Shape, from the fused scan in extractFeatures(); distances use it only when both sides have it
+    bool hasShape;
+    double runRatio;        // Monotone runs (either direction) per element: ~0 sorted or reversed, ~0.67 random
+    double longestRunRatio; // Longest monotone run over size
+    double descendingRatio; // Pairs with data[i] >= data[i+1] (0-1); with sortedness this gives the equal pairs
+    double rangeRatio;      // (max - min + 1) / size: below 1 means counting sort needs no more buckets than keys
+    double inversionRatio;  // Inversions in a strided sample over all its pairs: 0 sorted, 0.5 random, 1 reversed
     
-    Features(int s, double sort, double unique) 
-        : size(s), sortedness(sort), uniqueRatio(unique) {}
+    // Set by sampleFeatures(): sortedness and uniqueRatio lie within their margins with ~95% confidence
+    bool estimated;
+    double sortednessMargin;   // +- percentage points
+    double uniqueRatioMargin;  // +- absolute
+    
+    Features(int s, double sort, double unique, KeyType type = KEY_INT32) 
+        : size(s), sortedness(sort), uniqueRatio(unique), keyType(type), hasShape(false),
+          runRatio(0), longestRunRatio(0), descendingRatio(0), rangeRatio(0), inversionRatio(0),
+          estimated(false), sortednessMargin(0), uniqueRatioMargin(0) {}
 };
 
 
@@ -49,7 +79,7 @@ public:
     
     void addTrainingData(Features features, string bestAlgorithm);  // Add a training sample
     
-    void loadDefaultTrainingData();  // Load 26 hardcoded training samples
+    void loadDefaultTrainingData();  // Load 47 hardcoded training samples (26 int32, 21 other key types)
     
     bool loadTrainingDataFromFile(const string& filename);  // Load training data from CSV file
     
@@ -59,6 +89,8 @@ public:
     
     string predict(const Features& features);  // Predict best sorting algorithm using k-NN
     
+    string predict(const Features& features, double& confidence);  // Same, plus the winner's share of the votes (1 = unanimous, 0 = no data)
+    
     int getTrainingDataSize() const;  // Get number of training samples
     
     void setK(int kValue);  // Set number of neighbors to consider
@@ -0,0 +1,42 @@
+#ifndef MAPPED_SORT_H
+#define MAPPED_SORT_H
+
+#include <string>
+#include "knn_predictor.h"
+
+using namespace std;
+
+
+
+enum MappedSortMode {
+    MAPPED_IN_PLACE,    // MAP_SHARED on the input: the sorted keys are written back to the file
+    MAPPED_PRIVATE,     // MAP_PRIVATE on the input: sort copy-on-write pages, the file is left alone
+    MAPPED_TO_OUTPUT    // Copy into a MAP_SHARED mapping of the output file and sort there
+};
+
+struct MappedSortStats {  // What the predictor saw and where the time went
+    long long elements;
+    string algorithm;       // Label that sorted the mapping (registry label for int32, typed engine label otherwise)
+    double sortedness;
+    double uniqueRatio;     // Sketch estimate for int32, strided sample for other key types
+    double sortednessMargin;  // 95% margins when int32 features were sampled (n >= SAMPLED_FEATURE_MIN_SIZE), else 0
+    double uniqueRatioMargin;
+    double mapMs;           // open, mmap and (to-output mode) the copy
+    double featureMs;       // Feature scan plus prediction
+    double sortMs;
+    double syncMs;          // msync of a shared mapping
+    string error;           // Why mappedSort returned false
+    
+    MappedSortStats() : elements(0), sortedness(0), uniqueRatio(0), sortednessMargin(0), uniqueRatioMargin(0),
+                        mapMs(0), featureMs(0), sortMs(0), syncMs(0) {}
+};
+
+
+
+// Sort a raw binary file of native-endian keys (int32, int64, float or double) through mmap, with
+// no parsing and no intermediate vector. The whole file must fit in memory; larger int32 files go
+// through externalSort. An output file that is the input (same device and inode) is sorted in place.
+bool mappedSort(const string& inputFile, const string& outputFile, MappedSortMode mode,
+                KNNPredictor& predictor, MappedSortStats& stats, KeyType keyType = KEY_INT32);
+
+#endif
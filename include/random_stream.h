@@ -0,0 +1,118 @@
+#ifndef RANDOM_STREAM_H
+#define RANDOM_STREAM_H
+
+#include <cstdint>
+#include <limits>
+
+using namespace std;
+
+
+
+// xoshiro256** (Blackman & Vigna): 256 bits of state, period 2^256 - 1, a few cycles per 64-bit output.
+// jump() advances the stream by 2^128 outputs and longJump() by 2^192, which splits one seed into
+// non-overlapping streams for parallel fills. Meets UniformRandomBitGenerator, so it also drives
+// <random> distributions and shuffle().
+class Xoshiro256 {
+public:
+    typedef uint64_t result_type;
+
+    uint64_t state[4];
+
+    explicit Xoshiro256(uint64_t seed = 0) {  // Expand the seed with splitmix64, as the authors recommend
+        for (int i = 0; i < 4; i++) {
+            state[i] = splitMix64(seed);
+        }
+    }
+
+    static uint64_t splitMix64(uint64_t& x) {  // Advance x and return its mix; also a good 64-bit hash
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t next() {  // Next 64 random bits
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    result_type operator()() {
+        return next();
+    }
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return numeric_limits<uint64_t>::max();
+    }
+
+    uint32_t bounded(uint32_t range) {  // Uniform in [0, range): Lemire's multiply-shift, rejecting the biased sliver
+        uint64_t product = (next() >> 32) * range;
+        uint32_t low = (uint32_t)product;
+        if (low < range) {
+            uint32_t threshold = (0u - range) % range;
+            while (low < threshold) {
+                product = (next() >> 32) * range;
+                low = (uint32_t)product;
+            }
+        }
+        return product >> 32;
+    }
+
+    void jump() {  // Same state as 2^128 calls to next()
+        static const uint64_t polynomial[4] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+                                               0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+        applyJump(polynomial);
+    }
+
+    void longJump() {  // Same state as 2^192 calls to next()
+        static const uint64_t polynomial[4] = {0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull,
+                                               0x77710069854EE241ull, 0x39109BB02ACBE635ull};
+        applyJump(polynomial);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    void applyJump(const uint64_t polynomial[4]) {  // Sum the states selected by the jump polynomial's bits
+        uint64_t sum[4] = {0, 0, 0, 0};
+        for (int word = 0; word < 4; word++) {
+            for (int bit = 0; bit < 64; bit++) {
+                if (polynomial[word] & (1ull << bit)) {
+                    for (int i = 0; i < 4; i++) {
+                        sum[i] ^= state[i];
+                    }
+                }
+                next();
+            }
+        }
+        for (int i = 0; i < 4; i++) {
+            state[i] = sum[i];
+        }
+    }
+};
+
+
+
+uint64_t freshSeed();  // Different on every call and every run; print it to replay a dataset with the seeded generators
+
+// Fill out[0, n) with keys uniform in [low, high], a pure function of (seed, n, low, high): bit-identical for any
+// thread count and with or without AVX2. Blocks of RANDOM_FILL_BLOCK keys draw from their own jump-ahead stream,
+// so threads fill blocks independently (0 = all cores). Keys map 32 random bits by multiply-shift without
+// rejection; the bias is below (high - low + 1) / 2^32.
+void fillUniform(int* out, int n, int low, int high, uint64_t seed, int threadCount = 0);
+
+const int RANDOM_FILL_BLOCK = 1 << 16;  // Keys per jump-ahead stream; also the unit of parallel work
+
+#endif
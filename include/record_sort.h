@@ -0,0 +1,43 @@
+#ifndef RECORD_SORT_H
+#define RECORD_SORT_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "sorting_algorithms.h"
+#include "knn_predictor.h"
+
+using namespace std;
+
+
+
+// Records keep the key next to its payload (array of structs): a compare touches the same
+// cache line the following move needs, and nothing has to be re-joined after sorting.
+
+struct KeyValue32 {  // 32-bit key with a 32-bit payload (row id), 8 bytes
+    int key;
+    uint32_t value;
+};
+
+struct KeyValue64 {  // 32-bit key with a 64-bit payload (pointer or wide row id), 16 bytes
+    int key;
+    uint64_t value;
+};
+
+
+
+// Sort by key with the record kernel for a registry label: "Radix"/"Counting" -> LSD radix,
+// "Insertion"/"Bubble" -> insertion, "Merge"/"Tim"/"ParallelMerge" -> merge, anything else -> introsort.
+// stable = true keeps equal keys in input order (radix, insertion or merge only).
+
+SortResult sortKeyValues(vector<KeyValue32>& records, const string& label, bool stable = false);
+
+SortResult sortKeyValues(vector<KeyValue64>& records, const string& label, bool stable = false);
+
+SortResult sortKeyValues(vector<KeyValue32>& records, KNNPredictor& predictor, bool stable = false);  // Route by features of the keys
+
+SortResult sortKeyValues(vector<KeyValue64>& records, KNNPredictor& predictor, bool stable = false);  // Route by features of the keys
+
+SortResult argsort(const vector<int>& keys, vector<int>& order, KNNPredictor& predictor, bool stable = false);  // order[i] = index of the i-th smallest key
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+
+
+// Internal: the AVX2 scan, filter and fill kernels behind selection, feature extraction and fillUniform (scalar
+// fallbacks without AVX2), and the key hash the hash tables share. Included by the library sources only; the
+// sorting API is sorting_algorithms.h.
+
+// Home slot of key in an open-addressing table of 2^tableBits slots (4 <= tableBits <= 32): the top bits of a
+// Fibonacci multiply, which every key bit reaches, so keys sharing low zero bits still spread out
+inline unsigned hashSlot(int key, int tableBits) {
+    return ((unsigned)key * 2654435761u) >> (32 - tableBits);
+}
+
+int simdFirstBelow(const int* data, int n, int threshold);  // Index of the first key < threshold (n if none)
+
+int simdCollectRange(const int* data, int n, int low, int high, int* out, int capacity);  // Copy keys in [low, high] to out (needs capacity + 8 slots); -1 if more than capacity
+
+// Write each key's bijective 32-bit hash that is <= limit to out (needs n + 8 slots); returns the count.
+// With seen (an open-addressing table of hashes, free slots all ones), a hash already in its home slot
+// seen[h & seenMask] is dropped too: the sketch would only probe and discard it.
+int simdHashAtMost(const int* data, int n, unsigned limit, unsigned* out, const unsigned* seen = nullptr, unsigned seenMask = 0);
+
+struct ScanState {  // Running totals of the fused feature scan, carried from block to block
+    long long ascendingPairs;   // data[i] <= data[i + 1]
+    long long descendingPairs;  // data[i] >= data[i + 1]
+    long long turns;            // Pairs whose direction differs from the previous pair; equal pairs keep the direction
+    int currentRun;             // Pairs in the current (last) monotone run
+    int firstRun;               // Pairs in the first run, once it has ended (turns > 0)
+    int longestRun;             // Pairs in the longest run ended after the first one
+    int leadingEqual;           // Equal pairs before the first strict one; they join the first run
+    int firstDescending;        // Direction of the first strict pair, -1 none yet
+    int lastDescending;         // Direction of the previous pair: 1 descending, 0 ascending, -1 no strict pair yet
+    int minValue;
+    int maxValue;
+    
+    // The first run and leading pairs are kept apart so two scans can be joined exactly (see FeatureAccumulator)
+    ScanState() : ascendingPairs(0), descendingPairs(0), turns(0), currentRun(0), firstRun(0), longestRun(0),
+                  leadingEqual(0), firstDescending(-1), lastDescending(-1), minValue(0x7FFFFFFF), maxValue(-0x7FFFFFFF - 1) {}
+    
+    int longestAnyRun() const {  // Pairs in the longest run, open or ended
+        return max(max(firstRun, longestRun), currentRun);
+    }
+};
+
+// One pass over data[0, n): pair statistics for the first pairs pairs (pairs is n, or n - 1 when the block
+// ends the array), min/max, and the hash filter of simdHashAtMost. Returns the number of hashes written.
+int simdScanBlock(const int* data, int n, int pairs, unsigned limit, unsigned* out, ScanState& state,
+                  const unsigned* seen = nullptr, unsigned seenMask = 0);
+
+// Fill out[0, n) from four interleaved xoshiro256** streams, state[word][lane], advancing them. Step s writes keys
+// 8s..8s+7: the low then high 32 bits r of lanes 0..3, each mapped to low + ((r * range) >> 32), range <= 2^32.
+// The AVX2 and scalar paths produce identical keys.
+void simdFillUniform(int* out, int n, int low, uint64_t range, uint64_t state[4][4]);
+
+#endif
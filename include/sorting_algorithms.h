@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <algorithm>
 
 using namespace std;
 
@@ -11,20 +12,161 @@ using namespace std;
 struct SortResult {  // Sorting algorithm performance metrics
     string algorithmName;
     long long comparisons;
-    double timeMs;
+    long long moves;    // Element writes into the array or scratch buffer (a swap counts as two)
+    double timeMs;      // Wall-clock time
+    double cpuTimeMs;   // CPU time of the calling thread and the sort pool's workers, not of other threads in the process (equals timeMs for single-threaded sorts)
     
-    SortResult(string name, long long comp, double time)
-        : algorithmName(name), comparisons(comp), timeMs(time) {}
+    SortResult(string name, long long comp, double time, double cpuTime = -1.0, long long moveCount = 0)
+        : algorithmName(name), comparisons(comp), moves(moveCount), timeMs(time),
+          cpuTimeMs(cpuTime < 0 ? time : cpuTime) {}
 };
 
 
 
+struct NoCounter {  // Production instrumentation policy: every hook compiles away
+    void compare(long long = 1) {}
+    void move(long long = 1) {}
+    void add(const NoCounter&) {}
+};
+
+struct OperationCounter {  // Training/benchmark instrumentation policy: counts comparisons and moves
+    long long comparisons;
+    long long moves;
+    
+    OperationCounter() : comparisons(0), moves(0) {}
+    
+    void compare(long long count = 1) { comparisons += count; }
+    void move(long long count = 1) { moves += count; }
+    void add(const OperationCounter& other) {
+        comparisons += other.comparisons;
+        moves += other.moves;
+    }
+};
+
+
+
+// Counted entry points: time the sort and report OperationCounter totals
+
 SortResult bubbleSort(vector<int>& arr);  // O(n^2) comparison-based sort
 
 SortResult insertionSort(vector<int>& arr);  // O(n^2) sort, efficient for small/nearly sorted arrays
 
 SortResult mergeSort(vector<int>& arr);  // O(n log n) guaranteed, stable sort
 
-SortResult quickSort(vector<int>& arr);  // O(n log n) average, in-place sort
+SortResult quickSort(vector<int>& arr);  // Introsort: O(n log n) worst case, O(log n) stack, in-place
+
+SortResult blockQuickSort(vector<int>& arr);  // Introsort with branch-free BlockQuicksort partitioning
+
+SortResult simdQuickSort(vector<int>& arr);  // Introsort with AVX2 partition and sorting-network leaves (scalar fallback)
+
+SortResult radixSort(vector<int>& arr);  // O(n) LSD radix sort on 8-bit digits, stable, not comparison-based
+
+SortResult threeWayQuickSort(vector<int>& arr);  // Dutch-national-flag quicksort, near-linear on few distinct keys
+
+SortResult countingSort(vector<int>& arr);  // Counting sort for small value ranges, hash histogram for few distinct keys
+
+SortResult timSort(vector<int>& arr);  // Natural-run merge sort with galloping, near O(n) on presorted input, stable
+
+SortResult parallelMergeSort(vector<int>& arr, int threadCount = 0);  // Fork-join merge sort with parallel merge (0 = all cores)
+
+SortResult parallelQuickSort(vector<int>& arr, int threadCount = 0);  // Fork-join introsort (0 = all cores)
+
+// Sort values[offsets[i], offsets[i+1]) for every i in one call, aggregate metrics in result.
+// False (values untouched, error set) unless offsets are non-decreasing and inside values.
+bool segmentedSort(vector<int>& values, const vector<int>& offsets, SortResult& result, string& error, int threadCount = 0);
+
+
+
+// Selection: cheaper than a full sort when only the smallest k keys or one rank is needed
+
+SortResult nthElement(vector<int>& arr, int k);  // arr[k] = k-th smallest (0-based), smaller keys before it, larger after; O(n)
+
+SortResult partialSortTopK(vector<int>& arr, int k);  // arr[0, k) = the k smallest keys in order; the rest in unspecified order
+
+SortResult percentile(const vector<int>& arr, double p, int& value);  // Nearest-rank p-th percentile (0-100), arr untouched; O(n)
+
+
+
+// Sort engines, templated on the instrumentation policy (instantiated for NoCounter and OperationCounter)
+
+template <class Counter> void bubbleSortEngine(int* data, int n, Counter& counter);
+
+template <class Counter> void insertionSortEngine(int* data, int n, Counter& counter);
+
+template <class Counter> void mergeSortEngine(int* data, int n, Counter& counter);
+
+template <class Counter> void quickSortEngine(int* data, int n, Counter& counter);
+
+template <class Counter> void blockQuickSortEngine(int* data, int n, Counter& counter);
+
+template <class Counter> void simdQuickSortEngine(int* data, int n, Counter& counter);
+
+template <class Counter> void radixSortEngine(int* data, int n, Counter& counter);
+
+template <class Counter> void threeWayQuickSortEngine(int* data, int n, Counter& counter);
+
+template <class Counter> void countingSortEngine(int* data, int n, Counter& counter);
+
+template <class Counter> void timSortEngine(int* data, int n, Counter& counter);
+
+template <class Counter> void parallelMergeSortEngine(int* data, int n, int threadCount, Counter& counter);
+
+template <class Counter> void parallelQuickSortEngine(int* data, int n, int threadCount, Counter& counter);
+
+template <class Counter> void segmentedSortEngine(int* data, const int* offsets, int segments, int threadCount, Counter& counter);
+
+template <class Counter> void nthElementEngine(int* data, int n, int k, Counter& counter);
+
+template <class Counter> void partialSortEngine(int* data, int n, int k, Counter& counter);
+
+template <class Counter> int selectValueEngine(const int* data, int n, int k, Counter& counter);  // k-th smallest without modifying data
+
+
+
+typedef SortResult (*SortFunction)(vector<int>& arr);
+
+typedef void (*SortKernel)(int* data, int n);
+
+struct SortAlgorithm {  // An algorithm the predictor can choose from
+    string label;       // Label used in training data and predictions ("Quick", "Merge", ...)
+    SortFunction run;   // Timed and counted, for training and benchmarks
+    SortKernel kernel;  // Uninstrumented, for the production path
+    int minSize;        // Only worth timing on arrays at least this large
+    int maxSize;        // Too slow to time on larger arrays (0 = no limit)
+    
+    bool appliesTo(int n) const {  // Should this algorithm be timed on an array of n elements?
+        return n >= minSize && (maxSize == 0 || n <= maxSize);
+    }
+};
+
+const vector<SortAlgorithm>& getSortAlgorithms();  // All selectable algorithms, in display order
+
+const SortAlgorithm* findSortAlgorithm(const string& label);  // Look up by label (nullptr if unknown)
+
+
+
+// Range helpers shared by the sequential, SIMD and parallel engines
+
+template <class Counter> void insertionSortRange(int* data, int left, int right, Counter& counter);  // Sort data[left..right]
+
+template <class Counter> void mergeRuns(const int* src, int* dst, int left, int mid, int right, Counter& counter);  // Merge src[left, mid) and src[mid, right) into dst
+
+template <class Counter> void mergeSortRange(int* data, int* buffer, int n, Counter& counter);  // Sort data[0, n) using buffer[0, n) as scratch
+
+template <class Counter> void choosePivot(int* data, int low, int high, Counter& counter);  // Move median-of-three / ninther to data[high]
+
+template <class Counter> int partition(int* data, int low, int high, Counter& counter);  // Lomuto partition around data[high]
+
+template <class Counter> void heapSortRange(int* data, int low, int high, Counter& counter);  // Heapsort data[low..high]
+
+template <class Counter> void introSortLoop(int* data, int low, int high, int depthLimit, Counter& counter);  // Introsort data[low..high]
+
+int introSortDepthLimit(int n);  // Depth budget before the heapsort fallback
+
+template <class Counter> void radixSortRange(int* data, int* buffer, int n, Counter& counter);  // LSD radix sort data[0, n) using buffer[0, n) as scratch
+
+template <class Counter> void smallSortNetwork(int* data, int n, Counter& counter);  // Sort n <= 64 keys with the AVX2 network (insertion sort fallback)
+
+bool cpuHasAvx2();  // Runtime CPUID check guarding the AVX2 kernels
 
 #endif
@@ -0,0 +1,78 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+
+using namespace std;
+
+
+
+class ThreadPool {  // Work-stealing thread pool: one task deque per worker, idle workers steal from the others
+private:
+    struct WorkQueue {  // Per-worker deque: owner pushes/pops at the back, thieves take from the front
+        mutex lock;
+        deque<function<void()> > tasks;
+    };
+    
+    vector<unique_ptr<WorkQueue> > queues;  // queues[0] belongs to outside callers, queues[i] to worker i
+    vector<thread> workers;
+    mutex sleepLock;
+    condition_variable wakeUp;
+    atomic<int> queuedTasks;
+    atomic<bool> stopping;
+    int threadCount;
+    
+    void workerLoop(int index);  // Run tasks until the pool is destroyed
+    
+    bool popTask(int index, function<void()>& task);  // Take from own queue, otherwise steal from another
+    
+    int currentQueueIndex() const;  // Queue owned by the calling thread (0 when not a worker of this pool)
+
+public:
+    explicit ThreadPool(int threads = 0);  // Total threads including the caller (0 = hardware concurrency)
+    
+    ~ThreadPool();  // Finish queued tasks and join workers
+    
+    int getThreadCount() const;  // Number of threads that execute tasks, counting the waiting caller
+    
+    long long workerCpuNs();  // CPU time the worker threads (not the callers) have used so far, in nanoseconds
+    
+    void submit(const function<void()>& task);  // Queue a task for any thread to run
+    
+    bool runPendingTask();  // Run one queued task on the calling thread; false if none was available
+};
+
+
+
+class TaskGroup {  // Fork-join scope: run() forks tasks, wait() helps execute queued work until all finish
+private:
+    ThreadPool& pool;
+    atomic<int> pending;
+    mutex failureLock;
+    exception_ptr failure;  // First exception a task threw; wait() rethrows it
+    
+    void join();  // Help run queued tasks until pending reaches zero
+
+public:
+    explicit TaskGroup(ThreadPool& threadPool);
+    
+    ~TaskGroup();  // Waits for outstanding tasks; an exception nobody waited for is dropped
+    
+    void run(const function<void()>& task);  // Fork a task into the pool
+    
+    void wait();  // Join: execute pending tasks until every forked task has finished, then rethrow the first failure
+};
+
+
+
+ThreadPool& getSortThreadPool(int threadCount);  // Shared pool per thread count (0 = all cores): the parallel sorts and fills
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef TIMING_HARNESS_H
+#define TIMING_HARNESS_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "sorting_algorithms.h"
+
+using namespace std;
+
+
+
+long long monotonicNs();  // clock_gettime(CLOCK_MONOTONIC) in nanoseconds; a vDSO call reading the TSC, ~20 ns
+
+
+
+struct TimingConfig {  // How hard a race works to separate its candidates
+    int warmups;             // Untimed runs per candidate: caches, branch predictors, first-touch page faults
+    int batchTrials;         // Timed samples per candidate per batch; batches repeat until the winner separates
+    int maxTrials;           // Stop after this many samples; candidates still overlapping the winner are ties
+    long long minSampleNs;   // Sort enough fresh copies back to back that one sample spans at least this long
+    long long maxBatchKeys;  // Cap on copies * n, which bounds the scratch memory
+    double confidenceZ;      // Normal quantile behind the median's confidence interval
+    
+    TimingConfig() : warmups(2), batchTrials(5), maxTrials(45), minSampleNs(20000), maxBatchKeys(1 << 20), confidenceZ(1.96) {}
+};
+
+struct KernelTiming {  // One candidate's samples, reduced to per-sort milliseconds
+    string label;
+    double medianMs;
+    double madMs;    // Median absolute deviation of the samples
+    double lowMs;    // Distribution-free confidence interval of the median (order statistics)
+    double highMs;
+    int trials;      // Timed samples taken
+    int copies;      // Sorts per timed sample
+    
+    KernelTiming() : medianMs(0), madMs(0), lowMs(0), highMs(0), trials(0), copies(1) {}
+};
+
+struct RaceOutcome {  // Who won, and who could not be told apart from the winner
+    string winner;                 // Lowest median
+    vector<string> tiedWith;       // Candidates whose interval still overlapped the winner's after maxTrials
+    vector<KernelTiming> timings;  // Every candidate, in the order given
+    
+    bool isTie() const { return !tiedWith.empty(); }
+    
+    bool accepts(const string& label) const {  // Is label the winner or tied with it?
+        if (label == winner) return true;
+        for (const string& tied : tiedWith) {
+            if (tied == label) return true;
+        }
+        return false;
+    }
+};
+
+template <class Key>
+struct TimedKernel {  // A candidate: sorts the vector it is given in place
+    string label;
+    function<void(vector<Key>&)> run;
+};
+
+
+
+// Race the candidates on fresh copies of input: warm up, then interleave batches of timed samples across the
+// candidates still in contention. A candidate drops out once its median's interval lies wholly above the leader's.
+// Instantiated for int, long long, float, double and string keys.
+template <class Key>
+RaceOutcome raceKernels(const vector<Key>& input, const vector<TimedKernel<Key> >& candidates,
+                        const TimingConfig& config = TimingConfig());
+
+// Race the registry kernels (uninstrumented) that apply to the input size
+RaceOutcome raceSortAlgorithms(const vector<int>& input, bool singleThreadedOnly = false,
+                               const TimingConfig& config = TimingConfig());
+
+#endif
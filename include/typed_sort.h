@@ -0,0 +1,34 @@
+#ifndef TYPED_SORT_H
+#define TYPED_SORT_H
+
+#include <vector>
+#include <string>
+#include "sorting_algorithms.h"
+#include "knn_predictor.h"
+#include "key_traits.h"
+
+using namespace std;
+
+
+
+// Sorting for keys other than int32. The int32 registry keeps its specialised kernels (SIMD,
+// counting, parallel); other key types get one templated engine per family, ordered by keyLess().
+// Instantiated for long long, float, double and string.
+
+template <class Key> KeyType keyTypeOf();  // KEY_INT64 for long long, KEY_FLOAT, KEY_DOUBLE, KEY_STRING
+
+vector<string> getTypedSortLabels(KeyType type);  // Labels with a dedicated engine for this key type, for training races
+
+// Sort with the engine for a registry label: "Radix"/"Counting" -> LSD radix on KeyTraits::orderedBits
+// (strings: multikey quicksort), "Insertion"/"Bubble" -> insertion, "Merge"/"Tim"/"ParallelMerge" -> merge,
+// "MultikeyQuick" -> multikey quicksort (strings only), anything else -> introsort.
+template <class Key>
+SortResult sortTypedKeys(vector<Key>& keys, const string& label);
+
+template <class Key>
+SortResult sortTypedKeys(vector<Key>& keys, KNNPredictor& predictor);  // Predict from features tagged with the key type, then sort
+
+template <class Key>
+void typedSortKernel(Key* data, int n, const string& label);  // Uncounted sort of a raw buffer, e.g. a file mapping or a timing race
+
+#endif
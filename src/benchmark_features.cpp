@@ -0,0 +1,130 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "../include/dataset.h"
+#include "../include/knn_predictor.h"
+#include "../include/sorting_algorithms.h"
+
+using namespace std;
+using namespace chrono;
+
+
+
+const double FEATURE_BUDGET_PERCENT = 5.0;  // Feature extraction should cost at most this share of the sort
+
+
+
+static double elapsedMs(high_resolution_clock::time_point start) {  // Milliseconds since start
+    return duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() / 1e6;
+}
+
+vector<int> generateCase(const string& kind, int n, mt19937& gen) {  // Inputs whose distinct counts span the whole range
+    vector<int> data(n);
+    if (kind == "Random") {
+        for (int& x : data) x = (int)gen();
+    } else if (kind == "NearlySorted") {
+        for (int i = 0; i < n; i++) data[i] = i;
+        uniform_int_distribution<> index(0, n - 1);
+        for (int s = 0; s < n / 100; s++) swap(data[index(gen)], data[index(gen)]);
+    } else if (kind == "HalfDuplicates") {
+        uniform_int_distribution<> value(0, n / 2 - 1);
+        for (int& x : data) x = value(gen);
+    } else {
+        uniform_int_distribution<> value(0, 99);
+        for (int& x : data) x = value(gen);
+    }
+    return data;
+}
+
+
+
+int main(int argc, char* argv[]) {  // Usage: benchmark_features [relativeError] [maxSize] [training.csv]
+    double relativeError = argc > 1 ? atof(argv[1]) : UNIQUE_DEFAULT_ERROR;
+    int maxSize = min(argc > 2 ? atoi(argv[2]) : 1 << 24, 1 << 28);
+    
+    KNNPredictor predictor(5);
+    if (argc <= 3 || !predictor.loadTrainingDataFromFile(argv[3])) {
+        predictor.loadDefaultTrainingData();
+    }
+    mt19937 gen(12345);
+    
+    cout << "========================================" << endl;
+    cout << "  Feature Extraction Benchmark" << endl;
+    cout << "========================================" << endl;
+    cout << "Unique ratio: KMV sketch, relative error " << relativeError << endl;
+    cout << "Separate: sortedness pass + sketch pass; Fused: extractFeatures (one pass, all features);" << endl;
+    cout << "Sampled: sampleFeatures (staged probes), used from " << SAMPLED_FEATURE_MIN_SIZE << " keys; Pick: same algorithm as fused" << endl;
+    cout << "Budget: features as the sort tools compute them <= " << FEATURE_BUDGET_PERCENT << "% of the predicted sort" << endl << endl;
+    
+    cout << left << setw(10) << "Size" << setw(16) << "Data"
+         << right << setw(10) << "Exact" << setw(10) << "Sketch" << setw(9) << "Error"
+         << setw(13) << "Separate ms" << setw(10) << "Fused ms" << setw(12) << "Sampled ms" << setw(6) << "Pick" << setw(10) << "Exact ms"
+         << "  " << left << setw(12) << "Algorithm" << right << setw(10) << "Sort ms" << setw(10) << "Share" << endl;
+    cout << string(139, '-') << endl;
+    
+    int cases = 0, withinBudget = 0;
+    const char* kinds[] = {"Random", "NearlySorted", "HalfDuplicates", "FewUnique"};
+    for (int n = 1 << 20; n <= maxSize; n <<= 2) {
+        for (const char* kind : kinds) {
+            vector<int> data = generateCase(kind, n, gen);
+            
+            auto start = high_resolution_clock::now();
+            double sortedness = calculateSortedness(data.data(), n);
+            double sortednessMs = elapsedMs(start);
+            
+            start = high_resolution_clock::now();
+            double estimate = estimateUniqueRatio(data.data(), n, relativeError);
+            double sketchMs = elapsedMs(start);
+            
+            start = high_resolution_clock::now();
+            Features features = extractFeatures(data.data(), n);
+            double fusedMs = elapsedMs(start);
+            
+            start = high_resolution_clock::now();
+            Features sampled = sampleFeatures(data.data(), n);
+            double sampledMs = elapsedMs(start);
+            
+            start = high_resolution_clock::now();
+            double exact = exactUniqueRatio(data.data(), n);
+            double exactMs = elapsedMs(start);
+            
+            // Both paths must agree on sortedness; the fused estimate uses the default error
+            if (fabs(features.sortedness - sortedness) > 1e-9) {
+                cerr << "Fused sortedness " << features.sortedness << " != " << sortedness << endl;
+                return 1;
+            }
+            
+            // Time the sort the features select, on the same data
+            string label = predictor.predict(features);
+            bool samePick = predictor.predict(sampled) == label;
+            const SortAlgorithm* algorithm = findSortAlgorithm(label);
+            if (algorithm == nullptr || !algorithm->appliesTo(n)) {
+                algorithm = findSortAlgorithm("Quick");
+            }
+            start = high_resolution_clock::now();
+            algorithm->kernel(data.data(), n);
+            double sortMs = elapsedMs(start);
+            
+            double share = (n >= SAMPLED_FEATURE_MIN_SIZE ? sampledMs : fusedMs) * 100.0 / sortMs;
+            cases++;
+            if (share <= FEATURE_BUDGET_PERCENT) withinBudget++;
+            
+            cout << left << setw(10) << n << setw(16) << kind << right << fixed
+                 << setw(10) << setprecision(4) << exact << setw(10) << estimate
+                 << setw(8) << setprecision(2) << fabs(estimate - exact) * 100.0 / exact << "%"
+                 << setw(13) << setprecision(3) << sortednessMs + sketchMs << setw(10) << fusedMs
+                 << setw(12) << sampledMs << setw(6) << (samePick ? "yes" : "no") << setw(10) << exactMs
+                 << "  " << left << setw(12) << algorithm->label << right
+                 << setw(10) << sortMs << setw(9) << setprecision(1) << share << "%" << endl;
+        }
+    }
+    
+    cout << endl << "Within budget: " << withinBudget << "/" << cases << " cases" << endl;
+    return 0;
+}
@@ -0,0 +1,338 @@
+#include "../include/corpus.h"
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+
+
+const char CORPUS_MAGIC[8] = {'S', 'R', 'T', 'C', 'O', 'R', 'P', '1'};    // File header
+const char CORPUS_INDEX_MAGIC[8] = {'S', 'R', 'T', 'C', 'I', 'D', 'X', '1'};  // Last bytes of a finished file
+const size_t CORPUS_TRAILER_BYTES = 8 + 8 + 8;  // Index offset, record count, index magic
+const int CORPUS_MAX_VARINT_BYTES = 5;          // A zigzagged 33-bit delta
+
+
+
+static void putBytes(vector<unsigned char>& out, const void* data, size_t size) {  // Native-endian field
+    const unsigned char* bytes = (const unsigned char*)data;
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+static size_t encodeDeltaVarint(const int* keys, long long n, unsigned char* out) {  // Returns bytes written (up to 5n)
+    unsigned char* start = out;
+    long long previous = 0;
+    for (long long i = 0; i < n; i++) {
+        long long delta = (long long)keys[i] - previous;
+        uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+        while (zigzag >= 0x80) {
+            *out++ = (unsigned char)(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        *out++ = (unsigned char)zigzag;
+        previous = keys[i];
+    }
+    return out - start;
+}
+
+static bool decodeDeltaVarint(const unsigned char* in, size_t size, int* keys, long long n) {  // False if the payload is malformed
+    const unsigned char* end = in + size;
+    long long previous = 0;
+    for (long long i = 0; i < n; i++) {
+        uint64_t zigzag = 0;
+        int shift = 0;
+        while (true) {
+            if (in == end || shift >= 7 * CORPUS_MAX_VARINT_BYTES) return false;
+            unsigned char byte = *in++;
+            zigzag |= (uint64_t)(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) break;
+        }
+        previous += (long long)(zigzag >> 1) ^ -(long long)(zigzag & 1);
+        keys[i] = (int)previous;
+    }
+    return in == end;
+}
+
+
+
+struct CorpusRecordView {  // A record header parsed in place
+    uint32_t keys;
+    uint8_t encoding;
+    string source;
+    uint64_t payloadOffset;
+    uint64_t payloadBytes;
+    
+    uint64_t end() const { return payloadOffset + payloadBytes; }
+};
+
+static bool parseRecord(const unsigned char* base, size_t bytes, uint64_t offset, CorpusRecordView& view) {  // Bounds-checked header read
+    if (offset + 6 > bytes) return false;
+    memcpy(&view.keys, base + offset, 4);
+    view.encoding = base[offset + 4];
+    uint8_t sourceLength = base[offset + 5];
+    uint64_t position = offset + 6;
+    if (position + sourceLength + 8 > bytes) return false;
+    view.source.assign((const char*)base + position, sourceLength);
+    position += sourceLength;
+    memcpy(&view.payloadBytes, base + position, 8);
+    view.payloadOffset = position + 8;
+    if (view.encoding > CORPUS_DELTA_VARINT || view.payloadBytes > bytes - view.payloadOffset) return false;
+    return view.encoding != CORPUS_RAW || view.payloadBytes == (uint64_t)view.keys * sizeof(int);
+}
+
+
+
+CorpusWriter::CorpusWriter() : position(0), compress(true) {}
+
+CorpusWriter::~CorpusWriter() {
+    if (isOpen()) {
+        close();
+    }
+}
+
+bool CorpusWriter::open(const string& path, bool deltaVarint) {  // Header now, index at close
+    if (isOpen()) {
+        close();
+    }
+    offsets.clear();
+    compress = deltaVarint;
+    error.clear();
+    file.clear();
+    file.open(path.c_str(), ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        error = "cannot create " + path;
+        return false;
+    }
+    file.write(CORPUS_MAGIC, sizeof(CORPUS_MAGIC));
+    position = sizeof(CORPUS_MAGIC);
+    return !file.fail();
+}
+
+bool CorpusWriter::append(const int* keys, long long n, const string& source) {  // Smaller of the two encodings
+    if (!isOpen()) {
+        error = "corpus is not open";
+        return false;
+    }
+    if (n < 0 || n > 0xFFFFFFFFll || source.size() > 255) {
+        error = "record too large for the corpus format";
+        return false;
+    }
+    uint64_t rawBytes = (uint64_t)n * sizeof(int);
+    vector<unsigned char> encoded;
+    uint8_t encoding = CORPUS_RAW;
+    if (compress && n > 0) {
+        encoded.resize((size_t)n * CORPUS_MAX_VARINT_BYTES);
+        encoded.resize(encodeDeltaVarint(keys, n, encoded.data()));
+        if (encoded.size() < rawBytes) {
+            encoding = CORPUS_DELTA_VARINT;
+        }
+    }
+    uint64_t payloadBytes = encoding == CORPUS_RAW ? rawBytes : encoded.size();
+    
+    vector<unsigned char> header;
+    uint32_t count = n;
+    uint8_t sourceLength = source.size();
+    putBytes(header, &count, 4);
+    putBytes(header, &encoding, 1);
+    putBytes(header, &sourceLength, 1);
+    putBytes(header, source.data(), source.size());
+    putBytes(header, &payloadBytes, 8);
+    
+    file.write((const char*)header.data(), header.size());
+    if (encoding == CORPUS_RAW) {
+        file.write((const char*)keys, rawBytes);
+    } else {
+        file.write((const char*)encoded.data(), encoded.size());
+    }
+    if (file.fail()) {
+        error = "write failed";
+        return false;
+    }
+    offsets.push_back(position);
+    position += header.size() + payloadBytes;
+    return true;
+}
+
+bool CorpusWriter::close() {  // Index, then the fixed-size trailer that points at it
+    if (!isOpen()) {
+        return error.empty();
+    }
+    uint64_t indexOffset = position;
+    uint64_t recordCount = offsets.size();
+    file.write((const char*)offsets.data(), offsets.size() * sizeof(uint64_t));
+    file.write((const char*)&indexOffset, 8);
+    file.write((const char*)&recordCount, 8);
+    file.write(CORPUS_INDEX_MAGIC, sizeof(CORPUS_INDEX_MAGIC));
+    file.close();
+    if (file.fail()) {
+        error = "cannot write the corpus index";
+        return false;
+    }
+    return error.empty();
+}
+
+bool CorpusWriter::isOpen() const {
+    return file.is_open();
+}
+
+int CorpusWriter::getRecordCount() const {
+    return offsets.size();
+}
+
+const string& CorpusWriter::getError() const {
+    return error;
+}
+
+
+
+CorpusReader::CorpusReader() : mapping(nullptr), bytes(0) {}
+
+CorpusReader::~CorpusReader() {
+    close();
+}
+
+bool CorpusReader::open(const string& path) {  // Trailer first; fall back to walking the records
+    close();
+    error.clear();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(CORPUS_MAGIC)) {
+        ::close(fd);
+        error = path + " is not a corpus file";
+        return false;
+    }
+    bytes = info.st_size;
+    void* view = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        bytes = 0;
+        error = "cannot map " + path;
+        return false;
+    }
+    mapping = (const unsigned char*)view;
+    madvise(view, bytes, MADV_SEQUENTIAL);  // Replays read the records front to back
+    if (memcmp(mapping, CORPUS_MAGIC, sizeof(CORPUS_MAGIC)) != 0) {
+        close();
+        error = path + " is not a corpus file";
+        return false;
+    }
+    
+    if (bytes >= sizeof(CORPUS_MAGIC) + CORPUS_TRAILER_BYTES &&
+        memcmp(mapping + bytes - 8, CORPUS_INDEX_MAGIC, sizeof(CORPUS_INDEX_MAGIC)) == 0) {
+        uint64_t indexOffset, recordCount;
+        memcpy(&indexOffset, mapping + bytes - CORPUS_TRAILER_BYTES, 8);
+        memcpy(&recordCount, mapping + bytes - CORPUS_TRAILER_BYTES + 8, 8);
+        uint64_t indexEnd = bytes - CORPUS_TRAILER_BYTES;
+        if (indexOffset <= indexEnd && recordCount == (indexEnd - indexOffset) / sizeof(uint64_t) &&
+            (indexEnd - indexOffset) % sizeof(uint64_t) == 0) {
+            offsets.resize(recordCount);
+            memcpy(offsets.data(), mapping + indexOffset, recordCount * sizeof(uint64_t));
+            return true;
+        }
+    }
+    return walkRecords();
+}
+
+bool CorpusReader::walkRecords() {  // Keep every complete record; a torn last record is dropped
+    uint64_t offset = sizeof(CORPUS_MAGIC);
+    CorpusRecordView view;
+    while (parseRecord(mapping, bytes, offset, view)) {
+        offsets.push_back(offset);
+        offset = view.end();
+    }
+    return true;
+}
+
+void CorpusReader::close() {
+    if (mapping != nullptr) {
+        munmap((void*)mapping, bytes);
+    }
+    mapping = nullptr;
+    bytes = 0;
+    offsets.clear();
+}
+
+int CorpusReader::getRecordCount() const {
+    return offsets.size();
+}
+
+long long CorpusReader::getKeyCount(int index) const {
+    CorpusRecordView view;
+    if (index < 0 || index >= (int)offsets.size() || !parseRecord(mapping, bytes, offsets[index], view)) {
+        return -1;
+    }
+    return view.keys;
+}
+
+string CorpusReader::getSource(int index) const {
+    CorpusRecordView view;
+    if (index < 0 || index >= (int)offsets.size() || !parseRecord(mapping, bytes, offsets[index], view)) {
+        return "";
+    }
+    return view.source;
+}
+
+bool CorpusReader::read(int index, vector<int>& keys) const {  // Raw payloads are copied straight out of the mapping
+    CorpusRecordView view;
+    if (index < 0 || index >= (int)offsets.size() || !parseRecord(mapping, bytes, offsets[index], view)) {
+        return false;
+    }
+    keys.resize(view.keys);
+    if (view.keys == 0) {
+        return view.payloadBytes == 0;
+    }
+    if (view.encoding == CORPUS_RAW) {
+        memcpy(keys.data(), mapping + view.payloadOffset, view.payloadBytes);
+        return true;
+    }
+    return decodeDeltaVarint(mapping + view.payloadOffset, view.payloadBytes, keys.data(), view.keys);
+}
+
+const string& CorpusReader::getError() const {
+    return error;
+}
+
+
+
+static mutex captureLock;
+static CorpusWriter captureWriter;
+static atomic<bool> captureActive(false);
+static bool captureFailed = false;
+
+bool startSortCapture(const string& corpusFile, bool deltaVarint) {  // Replaces an active capture
+    lock_guard<mutex> guard(captureLock);
+    captureFailed = false;
+    bool opened = captureWriter.open(corpusFile, deltaVarint);
+    captureActive = opened;
+    return opened;
+}
+
+bool stopSortCapture() {  // Also true when no capture was running
+    lock_guard<mutex> guard(captureLock);
+    captureActive = false;
+    bool closed = captureWriter.close();
+    return closed && !captureFailed;
+}
+
+bool sortCaptureActive() {
+    return captureActive.load(memory_order_relaxed);
+}
+
+void captureSortInput(const int* keys, long long n, const string& source) {  // Serialised: records never interleave
+    if (!sortCaptureActive()) {
+        return;
+    }
+    lock_guard<mutex> guard(captureLock);
+    if (captureWriter.isOpen() && !captureWriter.append(keys, n, source)) {
+        captureFailed = true;
+    }
+}
@@ -1,23 +1,44 @@
 #include "../include/dataset.h"
+#include "../include/key_traits.h"
+#include "../include/sorting_algorithms.h"
+#include "../include/simd_kernels.h"
 #include <algorithm>
+#include <climits>
+#include <limits>
+#include <cmath>
 #include <random>
-#include <set>
+#include <unordered_set>
+#include <string>
 
 using namespace std;
 
-vector<int> generateRandom(int n) {  // Generate random integers in range [1, 10000]
+
+
+const int UNIQUE_EXACT_MAX_SIZE = 1 << 16;  // Up to this many keys the exact hash set is cheap enough
+const int UNIQUE_SKETCH_BLOCK = 4096;       // Keys hashed per filter call; the threshold tightens between blocks
+const int UNIQUE_MAX_SKETCH_SIZE = 1 << 20; // Cap on k however small the requested error
+const unsigned SKETCH_EMPTY = 0xFFFFFFFFu;  // Free table slot; the key hashing to it is tracked by a flag
+const int SKETCH_DENSE_RANGE = 1 << 16;     // Values one dense window flags; 64 KB, and the keys never get hashed
+const int INVERSION_SAMPLE_SIZE = 1024;     // Strided keys whose pairwise inversions estimate the whole array's
+const int SAMPLED_MIN_WINDOWS = 64;         // Contiguous windows probed for pair and run statistics, one per stratum,
+const int SAMPLED_WINDOW_COUNT = 1024;      //   growing fourfold up to this many
+const int SAMPLED_WINDOW_SIZE = 32;         // Keys per window (two cache lines)
+const double SAMPLED_SORTEDNESS_MARGIN = 2.0;  // Stop adding windows once sortedness is known within this many points
+const int SAMPLED_MIN_UNIQUE_KEYS = 1024;   // Scattered keys behind the distinct-count estimate,
+const int SAMPLED_UNIQUE_KEYS = 1 << 16;    //   doubling up to this many
+const double SAMPLED_UNIQUE_MARGIN = 0.1;   // Stop adding keys once the unique ratio is known within this much
+const int SAMPLED_SEED_KEYS = 16;           // Evenly spaced keys fingerprinted, with n, into the default probe seed
+const double CONFIDENCE_Z = 1.96;           // Two-sided 95% normal quantile for the reported margins
+
+
+
+vector<int> generateRandom(int n, uint64_t seed) {  // Random integers in range [1, 10000], filled in parallel
     vector<int> arr(n);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(1, 10000);
-    
-    for (int i = 0; i < n; i++) {
-        arr[i] = dis(gen);
-    }
+    fillUniform(arr.data(), n, 1, 10000, seed);
     return arr;
 }
 
-vector<int> generateNearlySorted(int n, int swaps) {  // Create sorted array then perform random swaps
+vector<int> generateNearlySorted(int n, int swaps, uint64_t seed) {  // Create sorted array then perform random swaps
     vector<int> arr(n);
     
     // Start with perfectly sorted array [1, 2, 3, ..., n]
@@ -25,14 +46,11 @@ vector<int> generateNearlySorted(int n, int swaps) {  // Create sorted array the
         arr[i] = i + 1;
     }
     
-    // Perform random swaps to introduce disorder
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(0, n - 1);
-    
-    for (int i = 0; i < swaps; i++) {
-        int idx1 = dis(gen);
-        int idx2 = dis(gen);
+    // Perform random swaps to introduce disorder; few enough that one stream keeps up
+    Xoshiro256 gen(seed);
+    for (int i = 0; i < swaps && n > 0; i++) {
+        int idx1 = gen.bounded(n);
+        int idx2 = gen.bounded(n);
         swap(arr[idx1], arr[idx2]);
     }
     
@@ -47,58 +65,1017 @@ vector<int> generateReversed(int n) {  // Generate descending sequence
     return arr;
 }
 
-vector<int> generateFewUnique(int n, int uniqueCount) {  // Generate array with limited unique values
+vector<int> generateFewUnique(int n, int uniqueCount, uint64_t seed) {  // Values in [1, uniqueCount], filled in parallel
     vector<int> arr(n);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(1, uniqueCount);
+    fillUniform(arr.data(), n, 1, uniqueCount, seed);
+    return arr;
+}
+
+vector<int> generateLargeRandom(int n, uint64_t seed) {  // Random integers in range [1, 100000], filled in parallel
+    vector<int> arr(n);
+    fillUniform(arr.data(), n, 1, 100000, seed);
+    return arr;
+}
+
+vector<int> generateRandom(int n) {  // Unseeded: a fresh seed per call
+    return generateRandom(n, freshSeed());
+}
+
+vector<int> generateNearlySorted(int n, int swaps) {
+    return generateNearlySorted(n, swaps, freshSeed());
+}
+
+vector<int> generateFewUnique(int n, int uniqueCount) {
+    return generateFewUnique(n, uniqueCount, freshSeed());
+}
+
+vector<int> generateLargeRandom(int n) {
+    return generateLargeRandom(n, freshSeed());
+}
+
+
+
+static double unitInterval(Xoshiro256& gen) {  // Uniform in [0, 1) from the top 53 bits
+    return (gen.next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static vector<int> segmentLengths(int n, int segments, Xoshiro256& gen) {  // Lengths in [L/2, 3L/2] for L = n / segments, summing to n
+    vector<int> lengths;
+    int average = max(1, n / max(1, segments));
+    for (int covered = 0; covered < n; ) {
+        int length = min(n - covered, max(1, average / 2 + (int)gen.bounded(average + 1)));
+        lengths.push_back(length);
+        covered += length;
+    }
+    return lengths;
+}
+
+class ZipfSampler {  // Rejection-inversion (Hormann & Derflinger): O(1) per draw, no table, any exponent > 0
+private:
+    double exponent;
+    double hIntegralX1;
+    double hIntegralN;
+    double squeeze;
+    
+    static double expm1OverX(double x) {  // (e^x - 1) / x, accurate near 0
+        return fabs(x) > 1e-8 ? expm1(x) / x : 1.0 + x / 2.0;
+    }
+    
+    static double log1pOverX(double x) {  // log(1 + x) / x, accurate near 0
+        return fabs(x) > 1e-8 ? log1p(x) / x : 1.0 - x / 2.0;
+    }
+    
+    double h(double x) const {
+        return exp(-exponent * log(x));
+    }
+    
+    double hIntegral(double x) const {  // Antiderivative of h
+        double logX = log(x);
+        return expm1OverX((1.0 - exponent) * logX) * logX;
+    }
+    
+    double hIntegralInverse(double x) const {
+        double t = max(-1.0, x * (1.0 - exponent));
+        return exp(log1pOverX(t) * x);
+    }
+
+public:
+    ZipfSampler(int distinctKeys, double zipfExponent) : exponent(zipfExponent) {
+        hIntegralX1 = hIntegral(1.5) - 1.0;
+        hIntegralN = hIntegral(distinctKeys + 0.5);
+        squeeze = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+    }
     
+    int sample(Xoshiro256& gen, int distinctKeys) const {  // Rank in [1, distinctKeys]
+        while (true) {
+            double u = hIntegralN + unitInterval(gen) * (hIntegralX1 - hIntegralN);
+            double x = hIntegralInverse(u);
+            int k = (int)min((double)distinctKeys, max(1.0, floor(x + 0.5)));
+            if (k - x <= squeeze || u >= hIntegral(k + 0.5) - h(k)) {
+                return k;
+            }
+        }
+    }
+};
+
+vector<int> generateZipf(int n, int distinctKeys, double exponent, uint64_t seed) {  // Skewed traffic: a few hot keys, a long tail
+    vector<int> arr(n);
+    distinctKeys = max(1, distinctKeys);
+    ZipfSampler sampler(distinctKeys, exponent);
+    Xoshiro256 gen(seed);
     for (int i = 0; i < n; i++) {
-        arr[i] = dis(gen);
+        arr[i] = sampler.sample(gen, distinctKeys);
     }
     return arr;
 }
 
-vector<int> generateLargeRandom(int n) {  // Generate large random integers in range [1, 100000]
+vector<int> generateSawtooth(int n, int teeth, uint64_t seed) {  // Each tooth counts up from 1
+    vector<int> arr(n);
+    Xoshiro256 gen(seed);
+    int i = 0;
+    for (int length : segmentLengths(n, teeth, gen)) {
+        for (int j = 0; j < length; j++) {
+            arr[i++] = j + 1;
+        }
+    }
+    return arr;
+}
+
+vector<int> generateOrganPipe(int n, int pipes, uint64_t seed) {  // 1, 2, ..., peak, ..., 2, 1 per pipe
+    vector<int> arr(n);
+    Xoshiro256 gen(seed);
+    int i = 0;
+    for (int length : segmentLengths(n, pipes, gen)) {
+        for (int j = 0; j < length; j++) {
+            arr[i++] = min(j, length - 1 - j) + 1;
+        }
+    }
+    return arr;
+}
+
+vector<int> generateSortedRuns(int n, int runs, uint64_t seed) {  // Like a batch of merged-later segments or shard outputs
+    vector<int> arr(n);
+    fillUniform(arr.data(), n, 1, 1000000, seed);
+    Xoshiro256 gen(Xoshiro256::splitMix64(seed));
+    int first = 0;
+    for (int length : segmentLengths(n, runs, gen)) {
+        sort(arr.begin() + first, arr.begin() + first + length);
+        first += length;
+    }
+    return arr;
+}
+
+vector<int> generateAppendedTail(int n, double tailFraction, uint64_t seed) {  // Log sorted by time, then late and new records
+    vector<int> arr(n);
+    Xoshiro256 gen(seed);
+    int tail = min(n, (int)(n * tailFraction));
+    int timestamp = 1;
+    for (int i = 0; i < n - tail; i++) {
+        timestamp += gen.bounded(4);  // Gaps of 0-3 ticks, so bursts share a timestamp
+        arr[i] = timestamp;
+    }
+    // The tail straddles the end of the sorted part: 5% of the head's span either side
+    int spread = max(1, timestamp / 20);
+    fillUniform(arr.data() + n - tail, tail, max(1, timestamp - spread), timestamp + spread, gen.next());
+    return arr;
+}
+
+vector<int> generateSortedWithOutliers(int n, double outlierFraction, uint64_t seed) {  // Sorted 1..n, then random slots get random keys
     vector<int> arr(n);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(1, 100000);
-    
     for (int i = 0; i < n; i++) {
-        arr[i] = dis(gen);
+        arr[i] = i + 1;
+    }
+    Xoshiro256 gen(seed);
+    int outliers = (int)(n * outlierFraction);
+    for (int i = 0; i < outliers; i++) {
+        arr[gen.bounded(n)] = 1 + gen.bounded(n);
     }
     return arr;
 }
 
+
+
+// Registry adapters: one shape parameter each, integer parameters rounded
+
+static vector<int> zipfWorkload(int n, double exponent, uint64_t seed) {  // Domain as large as the array, so the tail stays unique
+    return generateZipf(n, n, exponent, seed);
+}
+
+static vector<int> sawtoothWorkload(int n, double teeth, uint64_t seed) {
+    return generateSawtooth(n, (int)(teeth + 0.5), seed);
+}
+
+static vector<int> organPipeWorkload(int n, double pipes, uint64_t seed) {
+    return generateOrganPipe(n, (int)(pipes + 0.5), seed);
+}
+
+static vector<int> sortedRunsWorkload(int n, double runs, uint64_t seed) {
+    return generateSortedRuns(n, (int)(runs + 0.5), seed);
+}
+
+const vector<Workload>& getWorkloads() {  // Label, generator and parameter range; the five classic types keep their own tuned generators
+    static const vector<Workload> workloads = {
+        {"Zipf", zipfWorkload, "exponent", 0.6, 2.0},
+        {"Sawtooth", sawtoothWorkload, "teeth", 2, 64},
+        {"OrganPipe", organPipeWorkload, "pipes", 1, 16},
+        {"SortedRuns", sortedRunsWorkload, "runs", 2, 64},
+        {"AppendedTail", generateAppendedTail, "tail fraction", 0.01, 0.3},
+        {"Outliers", generateSortedWithOutliers, "outlier fraction", 0.001, 0.05}
+    };
+    return workloads;
+}
+
+const Workload* findWorkload(const string& label) {  // Linear lookup, the list is tiny
+    for (const Workload& workload : getWorkloads()) {
+        if (workload.label == label) {
+            return &workload;
+        }
+    }
+    return nullptr;
+}
+
 int getDatasetSize(vector<int>& arr) {  // Return number of elements
     return arr.size();
 }
 
 double calculateSortedness(vector<int>& arr) {  // Calculate percentage of ordered adjacent pairs
-    if (arr.size() <= 1) {
+    return calculateSortedness(arr.data(), arr.size());
+}
+
+double calculateSortedness(const int* data, int n) {  // Ordered adjacent pairs over a raw buffer (e.g. a file mapping)
+    if (n <= 1) {
         return 100.0;  // Single element or empty is perfectly sorted
     }
     
     // Count adjacent pairs that are in correct order
     int orderedPairs = 0;
-    for (size_t i = 0; i < arr.size() - 1; i++) {
-        if (arr[i] <= arr[i + 1]) {
+    for (int i = 0; i < n - 1; i++) {
+        if (data[i] <= data[i + 1]) {
             orderedPairs++;
         }
     }
     
     // Return percentage: (ordered pairs / total pairs) * 100
-    return (orderedPairs * 100.0) / (arr.size() - 1);
+    return (orderedPairs * 100.0) / (n - 1);
 }
 
 double calculateUniqueRatio(vector<int>& arr) {  // Calculate ratio of unique to total elements
-    if (arr.empty()) {
+    return calculateUniqueRatio(arr.data(), arr.size());
+}
+
+double calculateUniqueRatio(const int* data, int n) {  // Unique ratio over a raw buffer
+    return estimateUniqueRatio(data, n, UNIQUE_DEFAULT_ERROR);
+}
+
+double exactUniqueRatio(const int* data, int n) {  // Open-addressing hash set, at most half full
+    if (n <= 0) {
+        return 0.0;
+    }
+    
+    // size_t: 2n passes INT_MAX beyond 2^30 keys, and the doubling must not wrap where size_t is 32 bits
+    if ((size_t)n > numeric_limits<size_t>::max() / 4) {
+        return estimateUniqueRatio(data, n, UNIQUE_DEFAULT_ERROR);
+    }
+    int tableBits = 4;
+    size_t capacity = 16;
+    while (capacity < 2 * (size_t)n) {
+        capacity <<= 1;
+        tableBits++;
+    }
+    vector<int> slots(capacity);
+    vector<char> used(capacity, 0);
+    int distinct = 0;
+    for (int i = 0; i < n; i++) {
+        size_t slot = hashSlot(data[i], tableBits);
+        while (used[slot] && slots[slot] != data[i]) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (!used[slot]) {
+            used[slot] = 1;
+            slots[slot] = data[i];
+            distinct++;
+        }
+    }
+    return (double)distinct / n;
+}
+
+DistinctSketch::DistinctSketch(double relativeError)  // Empty sketch sized for the error
+    : emptySeen(false), shrunk(false), stored(0), limitValue(SKETCH_EMPTY), denseMode(true), denseBase(0) {
+    // Standard error of the KMV estimate is about 1 / sqrt(k - 2)
+    double k = ceil(1.0 / (relativeError * relativeError)) + 2;
+    sketchSize = (int)max(64.0, min(k, (double)UNIQUE_MAX_SKETCH_SIZE));
+    capacity = 16;
+    while (capacity < 4 * sketchSize) {
+        capacity <<= 1;
+    }
+    table.assign(capacity, SKETCH_EMPTY);
+}
+
+bool DistinctSketch::dense() const {  // Still flagging keys
+    return denseMode;
+}
+
+void DistinctSketch::insertKeys(const int* keys, int count) {  // Low-cardinality input never fills the sketch, so hashing it would probe every key
+    int i = 0;
+    if (denseMode) {
+        if (denseSeen.empty() && count > 0) {
+            // Centre the window on the first key; unsigned offsets wrap, so the window may straddle INT_MIN
+            denseSeen.assign(SKETCH_DENSE_RANGE, 0);
+            denseBase = (unsigned)keys[0] - SKETCH_DENSE_RANGE / 2;
+        }
+        for (; i < count; i++) {
+            unsigned offset = (unsigned)keys[i] - denseBase;
+            if (offset >= (unsigned)SKETCH_DENSE_RANGE) {
+                break;
+            }
+            denseSeen[offset] = 1;
+        }
+        if (i == count) {
+            return;
+        }
+        leaveDense();
+    }
+    
+    vector<unsigned> block(UNIQUE_SKETCH_BLOCK + 8);
+    for (; i < count; i += UNIQUE_SKETCH_BLOCK) {
+        int hashes = simdHashAtMost(keys + i, min(UNIQUE_SKETCH_BLOCK, count - i), limitValue, block.data(), slots(), slotMask());
+        insert(block.data(), hashes);
+    }
+}
+
+unsigned DistinctSketch::limit() const {  // Current filter threshold
+    return limitValue;
+}
+
+const unsigned* DistinctSketch::slots() const {  // Valid until the next insert() or merge()
+    return table.data();
+}
+
+unsigned DistinctSketch::slotMask() const {  // Capacity is a power of two
+    return capacity - 1;
+}
+
+void DistinctSketch::insert(const unsigned* hashes, int count) {  // Open addressing; shrink back to k at 2k
+    if (denseMode) {
+        leaveDense();
+    }
+    for (int i = 0; i < count; i++) {
+        unsigned h = hashes[i];
+        if (h > limitValue) {
+            continue;  // The limit dropped partway through this batch
+        }
+        if (h == SKETCH_EMPTY) {
+            if (!emptySeen) stored++;
+            emptySeen = true;
+            continue;
+        }
+        unsigned slot = h & (capacity - 1);
+        while (table[slot] != SKETCH_EMPTY && table[slot] != h) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (table[slot] != SKETCH_EMPTY) {
+            continue;
+        }
+        table[slot] = h;
+        stored++;
+        if (stored >= 2 * sketchSize) {
+            shrink();
+        }
+    }
+}
+
+void DistinctSketch::merge(const DistinctSketch& other) {  // Both hold at least the k smallest of their own hashes, so the union's k smallest survive
+    vector<unsigned> values = other.heldHashes();
+    limitValue = min(limitValue, other.limitValue);
+    shrunk = shrunk || other.shrunk;
+    insert(values.data(), values.size());
+}
+
+double DistinctSketch::estimateRatio(long long n) const {  // Distinct keys over n
+    if (n <= 0) {
+        return 0.0;
+    }
+    if (denseMode) {
+        return (double)count(denseSeen.begin(), denseSeen.end(), 1) / n;
+    }
+    // The hash is a bijection on 32-bit keys: fewer than k distinct hashes means every distinct key was counted
+    if (!shrunk && stored < sketchSize) {
+        return (double)stored / n;
+    }
+    vector<unsigned> values = heldHashes();
+    nth_element(values.begin(), values.begin() + sketchSize - 1, values.end());
+    double kthSmallest = (values[sketchSize - 1] + 1.0) / 4294967296.0;
+    double distinct = (sketchSize - 1) / kthSmallest;
+    return min(1.0, distinct / n);
+}
+
+vector<unsigned> DistinctSketch::heldHashes() const {  // Every hash in the table, plus the flagged one; hashes of the dense keys while dense
+    if (denseMode) {
+        vector<int> keys = denseKeys();
+        vector<unsigned> values(keys.size() + 8);
+        values.resize(simdHashAtMost(keys.data(), keys.size(), SKETCH_EMPTY, values.data()));
+        return values;
+    }
+    vector<unsigned> values;
+    values.reserve(stored);
+    for (unsigned h : table) {
+        if (h != SKETCH_EMPTY) values.push_back(h);
+    }
+    if (emptySeen) {
+        values.push_back(SKETCH_EMPTY);
+    }
+    return values;
+}
+
+vector<int> DistinctSketch::denseKeys() const {  // Offsets back to key values
+    vector<int> keys;
+    for (int offset = 0; offset < (int)denseSeen.size(); offset++) {
+        if (denseSeen[offset]) keys.push_back((int)(denseBase + offset));
+    }
+    return keys;
+}
+
+void DistinctSketch::leaveDense() {  // At most 2^16 keys; the table shrinks as usual while they go in
+    vector<unsigned> values = heldHashes();
+    denseMode = false;
+    vector<unsigned char>().swap(denseSeen);
+    insert(values.data(), values.size());
+}
+
+void DistinctSketch::shrink() {  // Keep the k smallest and lower the limit to the largest of them
+    vector<unsigned> values = heldHashes();
+    nth_element(values.begin(), values.begin() + sketchSize - 1, values.end());
+    limitValue = values[sketchSize - 1];
+    emptySeen = false;
+    shrunk = true;
+    
+    fill(table.begin(), table.end(), SKETCH_EMPTY);
+    for (int i = 0; i < sketchSize; i++) {
+        unsigned slot = values[i] & (capacity - 1);
+        while (table[slot] != SKETCH_EMPTY) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        table[slot] = values[i];
+    }
+    stored = sketchSize;
+}
+
+double estimateUniqueRatio(const int* data, int n, double relativeError) {  // KMV sketch over one hashing pass
+    if (n <= UNIQUE_EXACT_MAX_SIZE) {
+        return exactUniqueRatio(data, n);
+    }
+    
+    // Once the sketch is full, the vectorized filter discards nearly every key
+    DistinctSketch sketch(relativeError);
+    vector<unsigned> block(UNIQUE_SKETCH_BLOCK + 8);
+    for (int start = 0; start < n; start += UNIQUE_SKETCH_BLOCK) {
+        int length = min(UNIQUE_SKETCH_BLOCK, n - start);
+        if (sketch.dense()) {
+            sketch.insertKeys(data + start, length);
+            continue;
+        }
+        int count = simdHashAtMost(data + start, length, sketch.limit(), block.data(), sketch.slots(), sketch.slotMask());
+        sketch.insert(block.data(), count);
+    }
+    return sketch.estimateRatio(n);
+}
+
+
+
+double sampledInversionRatio(const int* data, int n, int sampleSize) {  // Merge-count inversions in an evenly strided sample
+    int m = min(n, sampleSize);
+    if (m < 2) {
+        return 0.0;
+    }
+    
+    vector<int> sample(m);
+    vector<int> buffer(m);
+    for (int i = 0; i < m; i++) {
+        sample[i] = data[(long long)i * n / m];
+    }
+    
+    // Bottom-up merge sort; every key taken from the right run jumps the keys left in the left run
+    long long inversions = 0;
+    for (int width = 1; width < m; width *= 2) {
+        for (int left = 0; left < m; left += 2 * width) {
+            int mid = min(left + width, m);
+            int right = min(left + 2 * width, m);
+            int i = left, j = mid, k = left;
+            while (i < mid && j < right) {
+                if (sample[j] < sample[i]) {
+                    inversions += mid - i;
+                    buffer[k++] = sample[j++];
+                } else {
+                    buffer[k++] = sample[i++];
+                }
+            }
+            while (i < mid) buffer[k++] = sample[i++];
+            while (j < right) buffer[k++] = sample[j++];
+        }
+        sample.swap(buffer);
+    }
+    return inversions / (m * (m - 1) / 2.0);
+}
+
+Features extractFeatures(vector<int>& arr) {  // Fused features of a vector
+    return extractFeatures(arr.data(), arr.size());
+}
+
+Features extractFeatures(const int* data, int n) {  // One read of the data for every feature but the sampled inversions
+    ScanState state;
+    DistinctSketch sketch(UNIQUE_DEFAULT_ERROR);
+    vector<unsigned> block(UNIQUE_SKETCH_BLOCK + 8);
+    bool exact = n <= UNIQUE_EXACT_MAX_SIZE;
+    for (int start = 0; start < n; start += UNIQUE_SKETCH_BLOCK) {
+        int length = min(UNIQUE_SKETCH_BLOCK, n - start);
+        int pairs = start + length < n ? length : length - 1;
+        // Small inputs count distinct keys exactly below, a dense sketch takes the keys themselves;
+        // a zero limit keeps the scan from emitting hashes for either
+        bool hashing = !exact && !sketch.dense();
+        unsigned limit = hashing ? sketch.limit() : 0;
+        int count = simdScanBlock(data + start, length, pairs, limit, block.data(), state, sketch.slots(), sketch.slotMask());
+        if (hashing) {
+            sketch.insert(block.data(), count);
+        } else if (!exact) {
+            sketch.insertKeys(data + start, length);
+        }
+    }
+    
+    Features features(n, n <= 1 ? 100.0 : state.ascendingPairs * 100.0 / (n - 1),
+                      exact ? exactUniqueRatio(data, n) : sketch.estimateRatio(n));
+    if (n <= 1) {
+        features.hasShape = true;
+        features.runRatio = n;
+        features.longestRunRatio = 1.0;
+        features.rangeRatio = n;
+        return features;
+    }
+    
+    features.hasShape = true;
+    features.runRatio = (state.turns + 1.0) / n;
+    features.longestRunRatio = (state.longestAnyRun() + 1.0) / n;
+    features.descendingRatio = state.descendingPairs / (n - 1.0);
+    features.rangeRatio = ((double)state.maxValue - state.minValue + 1.0) / n;
+    features.inversionRatio = sampledInversionRatio(data, n, INVERSION_SAMPLE_SIZE);
+    return features;
+}
+
+
+
+static double distinctOfDraws(double domain, double draws) {  // Expected distinct values among draws uniform picks from domain values
+    return -domain * expm1(draws * log1p(-1.0 / domain));
+}
+
+static double distinctFromSample(double sampleDistinct, int sampled, int n) {  // Population distinct count from a uniform sample
+    // Model the keys as n independent draws from an unknown domain of V equally likely values (how the
+    // generators here build their data): find V that explains sampleDistinct among sampled keys, then
+    // return the distinct count n draws from it would give. Expected distinct grows with V, so bisect on log V.
+    if (sampleDistinct >= sampled) {
+        return n;  // No repeats: indistinguishable from all distinct
+    }
+    double low = log(max(1.0, sampleDistinct));
+    double high = log(1e18);
+    for (int step = 0; step < 48; step++) {  // log V to within 1e-13: well below the sampling noise
+        double middle = (low + high) / 2;
+        if (distinctOfDraws(exp(middle), sampled) < sampleDistinct) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return min((double)n, distinctOfDraws(exp(high), n));
+}
+
+struct WindowProbe {  // Pair and run statistics of windowCount windows, one at a random offset in each of as many strata
+    int windowCount;
+    double ascendingSum, ascendingSquares, descendingSum, turnDensitySum;
+    long long longestRun;
+    int minValue, maxValue;
+    
+    double ascendingMean() const {
+        return ascendingSum / windowCount;
+    }
+    
+    double sortednessMargin() const {  // 1.96 standard errors of the mean across windows, in percent
+        double variance = max(0.0, (ascendingSquares - ascendingSum * ascendingMean()) / (windowCount - 1));
+        return CONFIDENCE_Z * sqrt(variance / windowCount) * 100.0;
+    }
+};
+
+static WindowProbe probeWindows(const int* data, int n, int windowCount, Xoshiro256& gen) {  // Scan one window per stratum
+    WindowProbe probe = {windowCount, 0, 0, 0, 0, 0, INT_MAX, INT_MIN};
+    unsigned unused[SAMPLED_WINDOW_SIZE + 8];
+    int streakStart = 0, streakDirection = -1;
+    for (int w = 0; w < windowCount; w++) {
+        long long stratumStart = (long long)w * n / windowCount;
+        long long stratumEnd = (long long)(w + 1) * n / windowCount;
+        long long offset = stratumStart + gen.next() % (stratumEnd - stratumStart - SAMPLED_WINDOW_SIZE + 1);
+        
+        // A zero limit keeps the scan from emitting hashes; only the pair statistics are wanted
+        ScanState window;
+        simdScanBlock(data + offset, SAMPLED_WINDOW_SIZE, SAMPLED_WINDOW_SIZE - 1, 0, unused, window);
+        probe.minValue = min(probe.minValue, window.minValue);
+        probe.maxValue = max(probe.maxValue, window.maxValue);
+        
+        double ascending = window.ascendingPairs / (SAMPLED_WINDOW_SIZE - 1.0);
+        probe.ascendingSum += ascending;
+        probe.ascendingSquares += ascending * ascending;
+        probe.descendingSum += window.descendingPairs / (SAMPLED_WINDOW_SIZE - 1.0);
+        probe.turnDensitySum += window.turns / (SAMPLED_WINDOW_SIZE - 2.0);  // The first pair has no predecessor to turn from
+        probe.longestRun = max(probe.longestRun, (long long)window.longestAnyRun());
+        
+        // An all-equal window (no strict pair) fits a streak in either direction
+        if (window.turns > 0) {
+            streakStart = w + 1;
+            streakDirection = -1;
+            continue;
+        }
+        if (window.lastDescending >= 0 && streakDirection >= 0 && window.lastDescending != streakDirection) {
+            streakStart = w;
+        }
+        if (window.lastDescending >= 0) {
+            streakDirection = window.lastDescending;
+        }
+        probe.longestRun = max(probe.longestRun, stratumEnd - (long long)streakStart * n / windowCount - 1);
+    }
+    return probe;
+}
+
+struct UniformSample {  // Keys at distinct uniformly random positions, in position order
+    vector<uint32_t> fractions;  // Position of each key as a 32-bit fraction of the array
+    vector<int> keys;
+};
+
+static void growSample(const int* data, int n, int draws, Xoshiro256& gen, UniformSample& sample) {  // Add draws uniform positions
+    // Not stratified: one key per stratum would never see the two copies of a key that sit side by side.
+    // The new fractions are counting-sorted into draws buckets by their top bits (about one per bucket) and merged
+    // into the sample, so the reads walk forward and a position drawn twice is read once, not taken for a repeat.
+    vector<int> bucketStart(draws + 1, 0);
+    vector<uint32_t> drawn(draws), fresh(draws, 0);
+    for (uint32_t& fraction : drawn) {
+        fraction = gen.next() >> 32;
+        bucketStart[((uint64_t)fraction * draws >> 32) + 1]++;
+    }
+    for (int b = 0; b < draws; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+    // Insertion within a bucket; a slot below it is an earlier bucket's, filled with smaller fractions or still 0
+    for (uint32_t fraction : drawn) {
+        int slot = bucketStart[(uint64_t)fraction * draws >> 32]++;
+        for (; slot > 0 && fresh[slot - 1] > fraction; slot--) {
+            fresh[slot] = fresh[slot - 1];
+        }
+        fresh[slot] = fraction;
+    }
+    
+    UniformSample merged;
+    merged.fractions.reserve(sample.fractions.size() + draws);
+    merged.keys.reserve(sample.keys.size() + draws);
+    long long previous = -1;
+    size_t kept = 0, freshIndex = 0;
+    while (kept < sample.fractions.size() || freshIndex < fresh.size()) {
+        bool takeKept = freshIndex == fresh.size()
+                        || (kept < sample.fractions.size() && sample.fractions[kept] <= fresh[freshIndex]);
+        uint32_t fraction = takeKept ? sample.fractions[kept++] : fresh[freshIndex++];
+        long long position = (uint64_t)fraction * n >> 32;
+        if (position == previous) continue;
+        previous = position;
+        merged.fractions.push_back(fraction);
+        merged.keys.push_back(takeKept ? sample.keys[kept - 1] : data[position]);
+    }
+    sample.fractions.swap(merged.fractions);
+    sample.keys.swap(merged.keys);
+}
+
+// Every feature from probes whose number depends on the data, not on n. Both samples start small and grow until their
+// 95% margin is tight enough (or they reach their cap), so few-unique input, whose sort is the fastest, stops after
+// the first round, while all-distinct input needs about sqrt(n) keys before a repeat-free sample rules out duplicates:
+// - sortedness, descendingRatio, runRatio: SAMPLED_MIN_WINDOWS to SAMPLED_WINDOW_COUNT windows of SAMPLED_WINDOW_SIZE
+//   keys (see probeWindows), four times as many each round until the sortedness margin is within
+//   SAMPLED_SORTEDNESS_MARGIN points.
+// - longestRunRatio: the longest in-window run, or a streak of consecutive windows monotone in one direction, taken to
+//   span their whole strata (an upper estimate: the unprobed gaps are assumed to continue the run).
+// - uniqueRatio: SAMPLED_MIN_UNIQUE_KEYS to SAMPLED_UNIQUE_KEYS keys at distinct uniformly random positions (see
+//   growSample), scaled up by distinctFromSample(), twice as many each round until the margin is within
+//   SAMPLED_UNIQUE_MARGIN. The margin maps a Poisson 95% interval on the number of repeats in the sample through the
+//   same estimate. It covers sampling noise only: data far from the uniform-domain model (every value exactly twice,
+//   heavy skew) can be off by more, up to about 25% of the ratio for exact duplicates.
+// - rangeRatio from the min/max of the probed keys (a lower estimate), inversionRatio from up to INVERSION_SAMPLE_SIZE of
+//   the unique-ratio keys (the array is not probed again).
+Features sampleFeatures(const int* data, int n) {  // Seeded by the input itself, so it always gets the same features (and prediction)
+    uint64_t seed = n;
+    for (int i = 0; i < SAMPLED_SEED_KEYS && n > 0; i++) {
+        seed = Xoshiro256::splitMix64(seed) ^ (unsigned)data[(long long)i * n / SAMPLED_SEED_KEYS];
+    }
+    return sampleFeatures(data, n, seed);
+}
+
+Features sampleFeatures(const int* data, int n, uint64_t seed) {  // Estimates from a data-dependent number of probes, flagged estimated
+    if (n < 4 * SAMPLED_UNIQUE_KEYS) {
+        return extractFeatures(data, n);  // Sampling would read a large share of the array anyway
+    }
+    
+    Xoshiro256 gen(seed);
+    WindowProbe probe = probeWindows(data, n, SAMPLED_MIN_WINDOWS, gen);
+    while (probe.windowCount < SAMPLED_WINDOW_COUNT && probe.sortednessMargin() > SAMPLED_SORTEDNESS_MARGIN) {
+        probe = probeWindows(data, n, probe.windowCount * 4, gen);
+    }
+    int minValue = probe.minValue;
+    int maxValue = probe.maxValue;
+    
+    // Each round doubles the sample with as many new draws; the union of independent uniform draws is one
+    // uniform sample, so no key is read twice
+    UniformSample sample;
+    const vector<int>& keys = sample.keys;
+    double uniqueRatio = 1.0, uniqueMargin = 0;
+    for (int drawn = 0, total = SAMPLED_MIN_UNIQUE_KEYS; total <= SAMPLED_UNIQUE_KEYS; drawn = total, total *= 2) {
+        growSample(data, n, total - drawn, gen, sample);
+        int sampled = keys.size();
+        double sampleDistinct = round(exactUniqueRatio(keys.data(), sampled) * sampled);
+        double repeatSpread = CONFIDENCE_Z * sqrt(sampled - sampleDistinct + 1.0);
+        uniqueRatio = distinctFromSample(sampleDistinct, sampled, n) / n;
+        double uniqueLow = distinctFromSample(max(1.0, sampleDistinct - repeatSpread), sampled, n) / n;
+        double uniqueHigh = distinctFromSample(min((double)sampled, sampleDistinct + repeatSpread), sampled, n) / n;
+        uniqueMargin = max(uniqueRatio - uniqueLow, uniqueHigh - uniqueRatio);
+        if (uniqueMargin <= SAMPLED_UNIQUE_MARGIN) {
+            break;
+        }
+    }
+    for (int key : keys) {
+        minValue = min(minValue, key);
+        maxValue = max(maxValue, key);
+    }
+    
+    double windows = probe.windowCount;
+    Features features(n, probe.ascendingMean() * 100.0, uniqueRatio);
+    features.estimated = true;
+    features.sortednessMargin = probe.sortednessMargin();
+    features.uniqueRatioMargin = uniqueMargin;
+    features.hasShape = true;
+    features.runRatio = (probe.turnDensitySum / windows * (n - 2) + 1.0) / n;
+    features.longestRunRatio = min(1.0, (probe.longestRun + 1.0) / n);
+    features.descendingRatio = probe.descendingSum / windows;
+    features.rangeRatio = ((double)maxValue - minValue + 1.0) / n;
+    // The unique-key sample is in position order and already read: a strided subset of it stands in for the
+    // strided probe of the array, which would cost a cache and TLB miss per key
+    features.inversionRatio = sampledInversionRatio(keys.data(), keys.size(), INVERSION_SAMPLE_SIZE);
+    return features;
+}
+
+
+
+// Join the scan of later keys onto the scan of the keys before them; frontLast and backFirst are the keys either side
+// of the seam. Runs are followed across it: the run open at the end of front, the seam pair, back's leading equal
+// pairs (which take the seam's direction) and the rest of back's first run, with a turn wherever direction changes.
+static void joinScans(ScanState& front, const ScanState& back, int frontLast, int backFirst) {
+    int seamDirection = frontLast > backFirst ? 1 : frontLast < backFirst ? 0 : front.lastDescending;
+    bool turnAtSeam = front.lastDescending >= 0 && seamDirection != front.lastDescending;
+    bool turnInBack = seamDirection >= 0 && back.firstDescending >= 0 && back.firstDescending != seamDirection;
+    int backFirstRun = back.turns > 0 ? back.firstRun : back.currentRun;
+    
+    ScanState joined = front;
+    auto endRun = [&joined](int length) {  // A turn: the open run ends with length pairs
+        if (joined.turns == 0) {
+            joined.firstRun = length;
+        } else {
+            joined.longestRun = max(joined.longestRun, length);
+        }
+        joined.turns++;
+    };
+    
+    int open = front.currentRun;
+    if (turnAtSeam) {
+        endRun(open);
+        open = 0;
+    }
+    open += 1 + back.leadingEqual;
+    if (turnInBack) {
+        endRun(open);
+        open = 0;
+    }
+    open += backFirstRun - back.leadingEqual;
+    if (back.turns > 0) {
+        endRun(open);  // Back's own first turn; its later runs and turns carry over unchanged
+        joined.turns += back.turns - 1;
+        joined.longestRun = max(joined.longestRun, back.longestRun);
+        open = back.currentRun;
+    }
+    joined.currentRun = open;
+    
+    joined.ascendingPairs += back.ascendingPairs + (frontLast <= backFirst ? 1 : 0);
+    joined.descendingPairs += back.descendingPairs + (frontLast >= backFirst ? 1 : 0);
+    if (front.firstDescending < 0) {
+        // Front had no strict pair: the seam, then back, decide the first direction
+        joined.firstDescending = frontLast != backFirst ? seamDirection : back.firstDescending;
+        joined.leadingEqual += frontLast != backFirst ? 0 : 1 + back.leadingEqual;
+    }
+    joined.lastDescending = back.lastDescending >= 0 ? back.lastDescending : seamDirection;
+    joined.minValue = min(front.minValue, back.minValue);
+    joined.maxValue = max(front.maxValue, back.maxValue);
+    front = joined;
+}
+
+FeatureAccumulator::FeatureAccumulator(double relativeError, int stream)  // Nothing seen yet; seeded, so runs repeat
+    : scan(new ScanState()), sketch(relativeError), count(0), firstKey(0), lastKey(0), nextSample(0), gen(INVERSION_SAMPLE_SIZE) {
+    for (int i = 0; i < stream; i++) {
+        gen.jump();  // Streams 2^128 draws apart never overlap
+    }
+}
+
+FeatureAccumulator::FeatureAccumulator(const FeatureAccumulator& other)  // Deep copy, scan state included
+    : scan(new ScanState(*other.scan)), sketch(other.sketch), count(other.count), firstKey(other.firstKey),
+      lastKey(other.lastKey), reservoir(other.reservoir), nextSample(other.nextSample), gen(other.gen) {}
+
+FeatureAccumulator& FeatureAccumulator::operator=(const FeatureAccumulator& other) {  // Copy-and-swap through the copy constructor
+    FeatureAccumulator copy(other);
+    swap(scan, copy.scan);
+    sketch = copy.sketch;
+    count = copy.count;
+    firstKey = copy.firstKey;
+    lastKey = copy.lastKey;
+    reservoir.swap(copy.reservoir);
+    nextSample = copy.nextSample;
+    gen = copy.gen;
+    return *this;
+}
+
+FeatureAccumulator::~FeatureAccumulator() {}  // Here, where ScanState is complete
+
+void FeatureAccumulator::append(const vector<int>& chunk) {  // Append a whole vector
+    append(chunk.data(), chunk.size());
+}
+
+void FeatureAccumulator::append(const int* data, int n) {  // Scan the chunk on its own, then join it at the seam
+    if (n <= 0) {
+        return;
+    }
+    
+    ScanState chunkScan;
+    vector<unsigned> block(UNIQUE_SKETCH_BLOCK + 8);
+    for (int start = 0; start < n; start += UNIQUE_SKETCH_BLOCK) {
+        int length = min(UNIQUE_SKETCH_BLOCK, n - start);
+        int pairs = start + length < n ? length : length - 1;
+        bool hashing = !sketch.dense();
+        int hashes = simdScanBlock(data + start, length, pairs, hashing ? sketch.limit() : 0, block.data(), chunkScan,
+                                   sketch.slots(), sketch.slotMask());
+        if (hashing) {
+            sketch.insert(block.data(), hashes);
+        } else {
+            sketch.insertKeys(data + start, length);
+        }
+    }
+    if (count == 0) {
+        *scan = chunkScan;
+        firstKey = data[0];
+    } else {
+        joinScans(*scan, chunkScan, lastKey, data[0]);
+    }
+    
+    // Fill the reservoir, then only visit the keys that win a place
+    long long end = count + n;
+    for (long long position = count; position < end && (int)reservoir.size() < INVERSION_SAMPLE_SIZE; position++) {
+        reservoir.push_back({randomUnit(), position, data[position - count]});
+        push_heap(reservoir.begin(), reservoir.end());
+        if ((int)reservoir.size() == INVERSION_SAMPLE_SIZE) {
+            nextSample = position + 1;
+            scheduleNextSample();
+        }
+    }
+    while ((int)reservoir.size() == INVERSION_SAMPLE_SIZE && nextSample < end) {
+        double threshold = reservoir.front().priority;
+        pop_heap(reservoir.begin(), reservoir.end());
+        reservoir.back() = {randomUnit() * threshold, nextSample, data[nextSample - count]};
+        push_heap(reservoir.begin(), reservoir.end());
+        nextSample++;
+        scheduleNextSample();
+    }
+    
+    count = end;
+    lastKey = data[n - 1];
+}
+
+void FeatureAccumulator::merge(const FeatureAccumulator& later) {  // Join scans, union sketches, keep the smallest priorities
+    if (later.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = later;
+        return;
+    }
+    
+    joinScans(*scan, *later.scan, lastKey, later.firstKey);
+    sketch.merge(later.sketch);
+    
+    for (SampledKey sampled : later.reservoir) {
+        sampled.position += count;
+        reservoir.push_back(sampled);
+    }
+    if ((int)reservoir.size() > INVERSION_SAMPLE_SIZE) {
+        nth_element(reservoir.begin(), reservoir.begin() + INVERSION_SAMPLE_SIZE - 1, reservoir.end());
+        reservoir.resize(INVERSION_SAMPLE_SIZE);
+    }
+    make_heap(reservoir.begin(), reservoir.end());
+    
+    count += later.count;
+    lastKey = later.lastKey;
+    if ((int)reservoir.size() == INVERSION_SAMPLE_SIZE) {
+        nextSample = count;
+        scheduleNextSample();
+    }
+}
+
+long long FeatureAccumulator::size() const {  // Keys appended or merged in
+    return count;
+}
+
+Features FeatureAccumulator::features() const {  // Finalize like extractFeatures(), from the running totals
+    const ScanState& scan = *this->scan;
+    int n = count;
+    Features features(n, n <= 1 ? 100.0 : scan.ascendingPairs * 100.0 / (n - 1), sketch.estimateRatio(n));
+    features.hasShape = true;
+    if (n <= 1) {
+        features.runRatio = n;
+        features.longestRunRatio = 1.0;
+        features.rangeRatio = n;
+        return features;
+    }
+    
+    features.runRatio = (scan.turns + 1.0) / n;
+    features.longestRunRatio = (scan.longestAnyRun() + 1.0) / n;
+    features.descendingRatio = scan.descendingPairs / (n - 1.0);
+    features.rangeRatio = ((double)scan.maxValue - scan.minValue + 1.0) / n;
+    
+    // The sample in array order; every pair in it is counted
+    vector<pair<long long, int>> ordered;
+    for (const SampledKey& sampled : reservoir) {
+        ordered.push_back(make_pair(sampled.position, sampled.key));
+    }
+    sort(ordered.begin(), ordered.end());
+    vector<int> keys;
+    for (const pair<long long, int>& sampled : ordered) {
+        keys.push_back(sampled.second);
+    }
+    features.inversionRatio = sampledInversionRatio(keys.data(), keys.size(), keys.size());
+    return features;
+}
+
+double FeatureAccumulator::randomUnit() {  // 53 random bits, offset off both ends
+    return ((gen.next() >> 11) + 0.5) / 9007199254740992.0;
+}
+
+void FeatureAccumulator::scheduleNextSample() {  // Each key beats the largest priority with probability equal to it
+    double threshold = reservoir.front().priority;
+    nextSample += (long long)(log(randomUnit()) / log1p(-threshold));
+}
+
+
+
+double sampleUniqueRatio(const int* data, int n, int sampleSize) {  // Unique ratio of an evenly strided sample
+    if (n <= sampleSize) {
+        return calculateUniqueRatio(data, n);
+    }
+    
+    int stride = n / sampleSize;
+    vector<int> sample;
+    sample.reserve(sampleSize);
+    for (int i = 0; i < n && (int)sample.size() < sampleSize; i += stride) {
+        sample.push_back(data[i]);
+    }
+    return exactUniqueRatio(sample.data(), sample.size());
+}
+
+
+
+template <class Key>
+double calculateSortedness(const Key* data, int n) {  // Ordered adjacent pairs under keyLess
+    if (n <= 1) {
+        return 100.0;
+    }
+    
+    int orderedPairs = 0;
+    for (int i = 0; i < n - 1; i++) {
+        if (!keyLess(data[i + 1], data[i])) {
+            orderedPairs++;
+        }
+    }
+    return (orderedPairs * 100.0) / (n - 1);
+}
+
+template <class Key>
+static size_t distinctSampleKeys(const vector<Key>& sample) {  // Numbers by their order-preserving image: equal images are exactly the keys keyLess cannot order
+    unordered_set<typename KeyTraits<Key>::Bits> seen;
+    seen.reserve(sample.size());
+    for (const Key& key : sample) {
+        seen.insert(KeyTraits<Key>::orderedBits(key));
+    }
+    return seen.size();
+}
+
+static size_t distinctSampleKeys(const vector<string>& sample) {  // Strings: keyLess is the natural order, so equality is ==
+    unordered_set<string> seen(sample.begin(), sample.end());
+    return seen.size();
+}
+
+template <class Key>
+double sampleUniqueRatio(const Key* data, int n, int sampleSize) {  // Strided sample; keys equal under keyLess count once
+    if (n <= 0) {
         return 0.0;
     }
     
-    // Use set to automatically count unique elements
-    set<int> uniqueElements(arr.begin(), arr.end());
-    return (double)uniqueElements.size() / arr.size();
+    int stride = max(1, n / sampleSize);
+    vector<Key> sample;
+    sample.reserve(min(n, sampleSize));
+    for (int i = 0; i < n && (int)sample.size() < sampleSize; i += stride) {
+        sample.push_back(data[i]);
+    }
+    return (double)distinctSampleKeys(sample) / sample.size();
 }
 
+template double calculateSortedness<long long>(const long long*, int);
+template double calculateSortedness<float>(const float*, int);
+template double calculateSortedness<double>(const double*, int);
+template double calculateSortedness<string>(const string*, int);
+template double sampleUniqueRatio<long long>(const long long*, int, int);
+template double sampleUniqueRatio<float>(const float*, int, int);
+template double sampleUniqueRatio<double>(const double*, int, int);
+template double sampleUniqueRatio<string>(const string*, int, int);
@@ -0,0 +1,273 @@
+#include "../include/external_sort.h"
+#include "../include/sorting_algorithms.h"
+#include "../include/dataset.h"
+#include "../include/corpus.h"
+#include <chrono>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+#include <unistd.h>
+
+using namespace std;
+using namespace chrono;
+
+
+
+const size_t EXTERNAL_MIN_CHUNK_BYTES = 64 * 1024;     // Smallest run-phase chunk, whatever the memory cap
+const size_t EXTERNAL_MIN_BUFFER_BYTES = 256 * 1024;   // Smallest per-run merge buffer; bounds the fan-in
+
+
+
+static double elapsedMs(high_resolution_clock::time_point start) {  // Milliseconds since start
+    return duration_cast<microseconds>(high_resolution_clock::now() - start).count() / 1000.0;
+}
+
+static string runFileName(const string& tempDir, int index) {  // Unique per process, so concurrent sorts can share tempDir
+    return tempDir + "/extsort_" + to_string((long long)getpid()) + "_" + to_string((long long)index) + ".run";
+}
+
+
+
+struct RunReader {  // Buffered sequential reader over one sorted run
+    ifstream file;
+    vector<int> buffer;
+    size_t pos;
+    size_t count;
+    long long* bytesRead;
+    
+    RunReader(const string& path, size_t bufferInts, long long* readCounter)
+        : file(path.c_str(), ios::binary), buffer(bufferInts), pos(0), count(0), bytesRead(readCounter) {
+        refill();
+    }
+    
+    void refill() {  // Load the next buffer; count stays 0 at end of run
+        pos = 0;
+        count = 0;
+        if (!file) return;
+        file.read((char*)buffer.data(), buffer.size() * sizeof(int));
+        count = file.gcount() / sizeof(int);
+        *bytesRead += count * sizeof(int);
+    }
+    
+    bool exhausted() const { return pos >= count; }
+    
+    int current() const { return buffer[pos]; }
+    
+    void advance() {
+        if (++pos == count) refill();
+    }
+};
+
+struct RunWriter {  // Buffered sequential writer
+    ofstream file;
+    vector<int> buffer;
+    size_t count;
+    long long* bytesWritten;
+    
+    RunWriter(const string& path, size_t bufferInts, long long* writeCounter)
+        : file(path.c_str(), ios::binary | ios::trunc), buffer(bufferInts), count(0), bytesWritten(writeCounter) {}
+    
+    void push(int value) {
+        buffer[count++] = value;
+        if (count == buffer.size()) flush();
+    }
+    
+    void flush() {
+        file.write((const char*)buffer.data(), count * sizeof(int));
+        *bytesWritten += count * sizeof(int);
+        count = 0;
+    }
+    
+    bool close() {  // Flush what is left; false on any write error
+        flush();
+        file.close();
+        return !file.fail();
+    }
+};
+
+
+
+class LoserTree {  // Tournament over k runs; each internal node remembers the loser of its match
+private:
+    vector<RunReader*>& sources;
+    vector<int> losers;  // losers[0] is the overall winner; nodes 1..k-1 are internal, k..2k-1 are the runs
+    int k;
+    
+    bool beats(int a, int b) const {  // Does run a's head come before run b's? Exhausted runs always lose
+        if (sources[a]->exhausted()) return false;
+        if (sources[b]->exhausted()) return true;
+        return sources[a]->current() < sources[b]->current();
+    }
+    
+    int build(int node) {  // Play the initial tournament below node; returns its winner
+        if (node >= k) return node - k;
+        int left = build(2 * node);
+        int right = build(2 * node + 1);
+        if (beats(left, right)) {
+            losers[node] = right;
+            return left;
+        }
+        losers[node] = left;
+        return right;
+    }
+
+public:
+    LoserTree(vector<RunReader*>& runs) : sources(runs), losers(runs.size()), k(runs.size()) {
+        losers[0] = k == 1 ? 0 : build(1);
+    }
+    
+    int winner() const { return losers[0]; }
+    
+    void replay() {  // The winner advanced: replay its path to the root, log k matches
+        int winner = losers[0];
+        for (int node = (winner + k) / 2; node >= 1; node /= 2) {
+            if (beats(losers[node], winner)) swap(losers[node], winner);
+        }
+        losers[0] = winner;
+    }
+};
+
+
+
+static bool mergeRunFiles(const vector<string>& runs, const string& outputFile, size_t memoryBytes,
+                          ExternalSortStats& stats) {  // k-way merge; memory split evenly over k inputs and one output
+    size_t bufferInts = max(EXTERNAL_MIN_BUFFER_BYTES, memoryBytes / (runs.size() + 1)) / sizeof(int);
+    
+    vector<RunReader*> readers;
+    bool ok = true;
+    for (const string& run : runs) {
+        readers.push_back(new RunReader(run, bufferInts, &stats.bytesRead));
+        if (!readers.back()->file.is_open()) ok = false;
+    }
+    
+    RunWriter writer(outputFile, bufferInts, &stats.bytesWritten);
+    if (!writer.file.is_open()) ok = false;
+    
+    if (ok && !readers.empty()) {
+        LoserTree tree(readers);
+        while (!readers[tree.winner()]->exhausted()) {
+            RunReader* source = readers[tree.winner()];
+            writer.push(source->current());
+            source->advance();
+            tree.replay();
+        }
+    }
+    
+    if (!writer.close()) ok = false;
+    for (RunReader* reader : readers) {
+        delete reader;
+    }
+    return ok;
+}
+
+
+
+bool externalSort(const string& inputFile, const string& outputFile, size_t memoryBytes,
+                  const string& tempDir, KNNPredictor& predictor, ExternalSortStats& stats) {  // Run phase, then merge phase
+    stats = ExternalSortStats();
+    
+    ifstream input(inputFile.c_str(), ios::binary | ios::ate);
+    if (!input.is_open()) {
+        stats.error = "cannot open " + inputFile;
+        return false;
+    }
+    long long fileBytes = input.tellg();
+    if (fileBytes % sizeof(int) != 0) {
+        stats.error = inputFile + " is not a whole number of int32 keys";
+        return false;
+    }
+    input.seekg(0);
+    stats.elements = fileBytes / sizeof(int);
+    
+    // Half the budget holds the chunk, the other half the kernel's scratch buffer (merge, radix, Tim)
+    size_t chunkInts = max(EXTERNAL_MIN_CHUNK_BYTES, memoryBytes / 2) / sizeof(int);
+    vector<int> chunk;
+    vector<string> runs;
+    
+    // Phase 1: sorted runs
+    auto runStart = high_resolution_clock::now();
+    long long remaining = stats.elements;
+    while (remaining > 0) {
+        chunk.resize(min((long long)chunkInts, remaining));
+        input.read((char*)chunk.data(), chunk.size() * sizeof(int));
+        if ((size_t)input.gcount() != chunk.size() * sizeof(int)) {
+            stats.error = "short read from " + inputFile;
+            break;
+        }
+        stats.bytesRead += chunk.size() * sizeof(int);
+        remaining -= chunk.size();
+        captureSortInput(chunk.data(), chunk.size(), "externalSort");
+        
+        // One fused pass (sampled for huge chunks); the unique ratio comes from a fixed-size distinct-count sketch
+        auto featureStart = high_resolution_clock::now();
+        Features features = chunk.size() >= (size_t)SAMPLED_FEATURE_MIN_SIZE ? sampleFeatures(chunk.data(), chunk.size())
+                                                                            : extractFeatures(chunk.data(), chunk.size());
+        string label = predictor.predict(features);
+        stats.featureMs += elapsedMs(featureStart);
+        
+        const SortAlgorithm* algorithm = findSortAlgorithm(label);
+        if (algorithm == nullptr || !algorithm->appliesTo(chunk.size())) {
+            algorithm = findSortAlgorithm("Quick");
+        }
+        stats.algorithmRuns[algorithm->label]++;
+        
+        auto sortStart = high_resolution_clock::now();
+        algorithm->kernel(chunk.data(), chunk.size());
+        stats.sortMs += elapsedMs(sortStart);
+        
+        string runFile = runFileName(tempDir, runs.size());
+        runs.push_back(runFile);
+        ofstream run(runFile.c_str(), ios::binary | ios::trunc);
+        run.write((const char*)chunk.data(), chunk.size() * sizeof(int));
+        run.close();
+        if (run.fail()) {
+            stats.error = "cannot write run " + runFile;
+            break;
+        }
+        stats.bytesWritten += chunk.size() * sizeof(int);
+    }
+    input.close();
+    vector<int>().swap(chunk);
+    stats.runCount = runs.size();
+    stats.runPhaseMs = elapsedMs(runStart);
+    
+    // Phase 2: merge; more runs than the fan-in allows are merged in several passes
+    auto mergeStart = high_resolution_clock::now();
+    size_t maxFanIn = max((size_t)2, memoryBytes / EXTERNAL_MIN_BUFFER_BYTES - 1);
+    int nextRun = runs.size();
+    vector<string> temporaries = runs;
+    
+    if (stats.error.empty()) {
+        while (runs.size() > maxFanIn) {
+            vector<string> merged;
+            for (size_t first = 0; first < runs.size(); first += maxFanIn) {
+                size_t last = min(runs.size(), first + maxFanIn);
+                vector<string> group(runs.begin() + first, runs.begin() + last);
+                string runFile = runFileName(tempDir, nextRun++);
+                temporaries.push_back(runFile);
+                if (!mergeRunFiles(group, runFile, memoryBytes, stats)) {
+                    stats.error = "cannot merge into " + runFile;
+                    break;
+                }
+                merged.push_back(runFile);
+            }
+            stats.mergePasses++;
+            runs.swap(merged);
+            if (!stats.error.empty()) break;
+        }
+    }
+    
+    if (stats.error.empty()) {
+        if (!mergeRunFiles(runs, outputFile, memoryBytes, stats)) {
+            stats.error = "cannot write " + outputFile;
+        }
+        stats.mergePasses++;
+    }
+    
+    for (const string& file : temporaries) {
+        remove(file.c_str());
+    }
+    stats.mergePhaseMs = elapsedMs(mergeStart);
+    
+    return stats.error.empty();
+}
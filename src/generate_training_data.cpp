@@ -5,14 +5,28 @@
 #include <random>
 #include <iomanip>
 #include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+#include <map>
+#include <deque>
+#include <set>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <sched.h>
 #include "../include/dataset.h"
 #include "../include/sorting_algorithms.h"
+#include "../include/typed_sort.h"
+#include "../include/corpus.h"
+#include "../include/timing_harness.h"
 
 using namespace std;
 
 
-random_device rd;
-mt19937 gen(rd());
+Xoshiro256 gen;  // Sizes and per-dataset seeds; seeded in main so a run can be replayed
 
 
 
@@ -58,7 +72,7 @@ vector<int> generateByType(DatasetType type, int sampleIndex, int totalSamplesPe
             } else {
                 size = largeSize(gen);
             }
-            dataset = generateRandom(size);
+            dataset = generateRandom(size, gen());
             break;
         }
         case TYPE_NEARLY_SORTED: {
@@ -74,7 +88,7 @@ vector<int> generateByType(DatasetType type, int sampleIndex, int totalSamplesPe
                 size = largeSize(gen);
                 swaps = swapsMedium(gen) * 2;
             }
-            dataset = generateNearlySorted(size, swaps);
+            dataset = generateNearlySorted(size, swaps, gen());
             break;
         }
         case TYPE_REVERSED: {
@@ -103,13 +117,13 @@ vector<int> generateByType(DatasetType type, int sampleIndex, int totalSamplesPe
                 uniques = uniqueCount(gen) * 2;
             }
             uniques = max(2, min(uniques, size));
-            dataset = generateFewUnique(size, uniques);
+            dataset = generateFewUnique(size, uniques, gen());
             break;
         }
         case TYPE_LARGE_RANDOM: {
             uniform_int_distribution<> veryLargeSize(1000, 10000);
             int size = veryLargeSize(gen);
-            dataset = generateLargeRandom(size);
+            dataset = generateLargeRandom(size, gen());
             break;
         }
     }
@@ -117,56 +131,429 @@ vector<int> generateByType(DatasetType type, int sampleIndex, int totalSamplesPe
     return dataset;
 }
 
+vector<int> generateWorkloadSample(const Workload& workload, int sampleIndex, int totalSamplesPerType) {  // Registry workload: same size bands, log-uniform parameter
+    uniform_int_distribution<> smallSize(10, 500);
+    uniform_int_distribution<> mediumSize(100, 2000);
+    uniform_int_distribution<> largeSize(500, 5000);
+    uniform_real_distribution<> unit(0.0, 1.0);
+    
+    int size;
+    if (sampleIndex < totalSamplesPerType / 3) {
+        size = smallSize(gen);
+    } else if (sampleIndex < 2 * totalSamplesPerType / 3) {
+        size = mediumSize(gen);
+    } else {
+        size = largeSize(gen);
+    }
+    double parameter = workload.minParameter * pow(workload.maxParameter / workload.minParameter, unit(gen));
+    return workload.generate(size, parameter, gen());
+}
 
 
-struct TestResult {
-    string algorithm;
-    double timeMs;
-};
 
-string findBestAlgorithm(vector<int>& dataset, bool verbose = false) {  // Test all algorithms and return fastest
-    vector<TestResult> results;
-    bool skipSlow = dataset.size() > 1000;
+RaceOutcome findBestAlgorithm(vector<int>& dataset, bool singleThreaded = false, bool verbose = false) {  // Race all algorithms until the winner separates
+    RaceOutcome outcome = raceSortAlgorithms(dataset, singleThreaded);
+    
+    if (verbose) {
+        cout << "  Results: ";
+        for (const KernelTiming& timing : outcome.timings) {
+            cout << timing.label << "=" << fixed << setprecision(4) << timing.medianMs << "+-" << timing.madMs << "ms ";
+        }
+        cout << " -> " << outcome.winner;
+        for (const string& tied : outcome.tiedWith) {
+            cout << " =" << tied;
+        }
+        cout << endl;
+    }
+    
+    return outcome;
+}
+
+string joinTies(const RaceOutcome& outcome) {  // tiedWith column: labels separated by ';'
+    string joined;
+    for (const string& tied : outcome.tiedWith) {
+        if (!joined.empty()) joined += ";";
+        joined += tied;
+    }
+    return joined;
+}
+
+
+
+template <class Key>
+RaceOutcome findBestTypedAlgorithm(vector<Key>& dataset) {  // Race the typed engines for one key type
+    vector<TimedKernel<Key> > candidates;
+    for (const string& label : getTypedSortLabels(keyTypeOf<Key>())) {
+        if (label == "Insertion" && dataset.size() > 1000) {
+            continue;  // Quadratic; never the winner at this size
+        }
+        TimedKernel<Key> candidate;
+        candidate.label = label;
+        candidate.run = [label](vector<Key>& keys) { typedSortKernel(keys.data(), keys.size(), label); };
+        candidates.push_back(candidate);
+    }
+    return raceKernels(dataset, candidates);
+}
+
+template <class Key>
+void writeTypedSample(ostream& file, vector<Key>& keys, const char* typeName) {  // One CSV row for a typed copy of a dataset
+    double sortedness = calculateSortedness(keys.data(), keys.size());
+    double uniqueRatio = sampleUniqueRatio(keys.data(), keys.size(), keys.size());
+    RaceOutcome best = findBestTypedAlgorithm(keys);
     
+    file << keys.size() << ","
+         << fixed << setprecision(2) << sortedness << ","
+         << fixed << setprecision(4) << uniqueRatio << ","
+         << best.winner << ","
+         << typeName << ","
+         << getKeyTypeName(keyTypeOf<Key>()) << ",,,,,,"  // The shape columns are int32 only
+         << joinTies(best) << endl;
+}
 
-    if (!skipSlow) {
-        vector<int> arr1 = dataset;
-        SortResult result1 = bubbleSort(arr1);
-        results.push_back({"Bubble", result1.timeMs});
+void writeTypedSamples(ostream& file, const vector<int>& dataset, const char* typeName) {  // Same shape as int64 timestamps, doubles and strings
+    vector<long long> timestamps(dataset.size());
+    vector<double> reals(dataset.size());
+    vector<string> names(dataset.size());
+    for (size_t i = 0; i < dataset.size(); i++) {
+        timestamps[i] = 1700000000000LL + dataset[i] * 1000LL;
+        reals[i] = dataset[i] / 7.0 - 500.0;
         
-        vector<int> arr2 = dataset;
-        SortResult result2 = insertionSort(arr2);
-        results.push_back({"Insertion", result2.timeMs});
+        // Zero-padded, so string order matches the integer order of the source
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "key%010d", dataset[i]);
+        names[i] = buffer;
     }
     
-    vector<int> arr3 = dataset;
-    SortResult result3 = mergeSort(arr3);
-    results.push_back({"Merge", result3.timeMs});
+    writeTypedSample(file, timestamps, typeName);
+    writeTypedSample(file, reals, typeName);
+    writeTypedSample(file, names, typeName);
+}
+
+void writeHeader(ostream& file) {  // CSV columns, shape features last
+    file << "size,sortedness,uniqueRatio,bestAlgorithm,datasetType,keyType,"
+         << "runRatio,longestRunRatio,descendingRatio,rangeRatio,inversionRatio,tiedWith" << endl;
+}
+
+void writeRow(ostream& file, const Features& features, const RaceOutcome& best, const char* typeName) {  // One int32 CSV row
+    file << features.size << ","
+         << fixed << setprecision(2) << features.sortedness << ","
+         << fixed << setprecision(4) << features.uniqueRatio << ","
+         << best.winner << ","
+         << typeName << ","
+         << getKeyTypeName(KEY_INT32) << ","
+         << setprecision(6) << features.runRatio << ","
+         << features.longestRunRatio << ","
+         << features.descendingRatio << ","
+         << features.rangeRatio << ","
+         << features.inversionRatio << ","
+         << joinTies(best) << endl;
+}
+
+void writeSample(ostream& file, vector<int>& dataset, const char* typeName, bool typedSamples,
+                 bool singleThreaded = false) {  // Race the algorithms, write the int32 row (and typed rows)
+    Features features = extractFeatures(dataset);
+    RaceOutcome best = findBestAlgorithm(dataset, singleThreaded);
+    writeRow(file, features, best, typeName);
+    
+    if (typedSamples) {
+        writeTypedSamples(file, dataset, typeName);
+    }
+}
+
+
+
+vector<int> allowedCpus() {  // CPUs this process may run on, ascending
+    vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return cpus;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+bool pinCurrentThread(const vector<int>& cpus) {  // Restrict the calling thread to cpus
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+
+
+class SamplePipeline {  // Workers pinned one per core race the algorithms; rows reach the file in submission order
+private:
+    struct Job {
+        long long index;
+        vector<int> dataset;
+        const char* typeName;
+    };
     
-    vector<int> arr4 = dataset;
-    SortResult result4 = quickSort(arr4);
-    results.push_back({"Quick", result4.timeMs});
+    ostream& out;
+    bool typedSamples;
+    vector<thread> workers;
+    mutex lock;
+    condition_variable jobReady;
+    condition_variable slotFree;
+    deque<Job> jobs;
+    size_t capacity;                  // Queued datasets; bounds memory however far the producer runs ahead
+    bool closing;
+    long long submitted;
+    long long nextToWrite;
+    map<long long, string> finished;  // Rows that completed ahead of an earlier one
     
+    void workerLoop(int cpu) {  // Own core for the whole run, so no timing shares a core with another
+        pinCurrentThread(vector<int>(1, cpu));
+        while (true) {
+            Job job;
+            {
+                unique_lock<mutex> guard(lock);
+                jobReady.wait(guard, [this] { return closing || !jobs.empty(); });
+                if (jobs.empty()) return;
+                job = move(jobs.front());
+                jobs.pop_front();
+                slotFree.notify_one();
+            }
+            
+            ostringstream rows;
+            writeSample(rows, job.dataset, job.typeName, typedSamples, true);
+            
+            lock_guard<mutex> guard(lock);
+            finished[job.index] = rows.str();
+            while (!finished.empty() && finished.begin()->first == nextToWrite) {
+                out << finished.begin()->second;
+                finished.erase(finished.begin());
+                nextToWrite++;
+            }
+        }
+    }
 
-    string fastest = results[0].algorithm;
-    double minTime = results[0].timeMs;
+public:
+    SamplePipeline(ostream& output, bool typed, const vector<int>& cpus)
+        : out(output), typedSamples(typed), capacity(4 * cpus.size()), closing(false), submitted(0), nextToWrite(0) {
+        for (int cpu : cpus) {
+            workers.push_back(thread(&SamplePipeline::workerLoop, this, cpu));
+        }
+    }
+    
+    ~SamplePipeline() {
+        finish();
+    }
+    
+    void submit(vector<int>& dataset, const char* typeName) {  // Takes the dataset; blocks while the queue is full
+        unique_lock<mutex> guard(lock);
+        slotFree.wait(guard, [this] { return jobs.size() < capacity; });
+        Job job;
+        job.index = submitted++;
+        job.dataset.swap(dataset);
+        job.typeName = typeName;
+        jobs.push_back(move(job));
+        jobReady.notify_one();
+    }
     
-    for (const auto& result : results) {
-        if (result.timeMs < minTime) {
-            minTime = result.timeMs;
-            fastest = result.algorithm;
+    void finish() {  // Drain the queue and join; every row has been written afterwards
+        {
+            lock_guard<mutex> guard(lock);
+            closing = true;
         }
+        jobReady.notify_all();
+        for (thread& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+};
+
+
+
+int replayCorpus(const string& corpusFile, const string& outputFile, bool typedSamples) {  // One training row per captured array, datasetType = capture source
+    CorpusReader corpus;
+    if (!corpus.open(corpusFile)) {
+        cerr << "Error: " << corpus.getError() << endl;
+        return 1;
     }
+    ofstream file(outputFile);
+    if (!file.is_open()) {
+        cerr << "Error: Cannot create output file: " << outputFile << endl;
+        return 1;
+    }
+    writeHeader(file);
     
-    if (verbose) {
-        cout << "  Results: ";
-        for (const auto& r : results) {
-            cout << r.algorithm << "=" << fixed << setprecision(3) << r.timeMs << "ms ";
+    cout << "Replaying " << corpus.getRecordCount() << " captured arrays from " << corpusFile << endl;
+    time_t startTime = time(nullptr);
+    int replayed = 0;
+    vector<int> dataset;
+    for (int i = 0; i < corpus.getRecordCount(); i++) {
+        if (!corpus.read(i, dataset)) {
+            cerr << "  [WARN] Record " << i << " is corrupt; skipped" << endl;
+            continue;
         }
-        cout << " -> " << fastest << endl;
+        string source = corpus.getSource(i);
+        writeSample(file, dataset, source.empty() ? "Captured" : source.c_str(), typedSamples);
+        replayed++;
+        if ((i + 1) % 50 == 0) {
+            cout << "\r  Progress: " << (i + 1) << "/" << corpus.getRecordCount();
+            cout.flush();
+        }
+    }
+    file.close();
+    
+    cout << "\nReplayed " << replayed << " arrays into " << outputFile << " in "
+         << (int)difftime(time(nullptr), startTime) << " seconds" << endl;
+    return 0;
+}
+
+
+
+// Adaptive sampling: candidates come from the same generators as a full run, but only those the current model is
+// least sure about get raced. A coarse grid over (size, sortedness, uniqueRatio) seeds the model first.
+const int ADAPTIVE_SIZE_EDGES[] = {100, 1000, 3000};                    // Grid cell boundaries
+const double ADAPTIVE_SORTEDNESS_EDGES[] = {10, 40, 60, 90, 99};
+const double ADAPTIVE_UNIQUE_EDGES[] = {0.05, 0.3, 0.8};
+const int ADAPTIVE_SEED_DRAWS = 2000;  // Candidates drawn to find one dataset per grid cell (generation only, no races)
+const int ADAPTIVE_CANDIDATES = 64;    // Candidates scored per batch; scoring is a predict() each
+const int ADAPTIVE_BATCH = 8;          // Raced per batch: the least confident, plus ADAPTIVE_EXPLORE at random
+const int ADAPTIVE_EXPLORE = 2;        // Random picks keep exploring and, being unbiased, are what accuracy is measured on
+const int ADAPTIVE_WINDOW = 50;        // Accuracy is the model's hit rate on the last this many random picks, predicted before they were added
+
+struct AdaptiveCandidate {  // A generated dataset waiting to be raced
+    vector<int> dataset;
+    Features features;
+    const char* typeName;
+    double confidence;
+    
+    AdaptiveCandidate() : features(0, 0, 0), typeName(""), confidence(0) {}
+};
+
+AdaptiveCandidate drawAdaptiveCandidate() {  // Any classic type or registered workload, any size band
+    const int classicDatasetTypes = 5;
+    DatasetType types[] = {TYPE_RANDOM, TYPE_NEARLY_SORTED, TYPE_REVERSED, TYPE_FEW_UNIQUE, TYPE_LARGE_RANDOM};
+    const vector<Workload>& workloads = getWorkloads();
+    int typeIdx = gen.bounded(classicDatasetTypes + workloads.size());
+    int band = gen.bounded(3);  // Small, medium or large: the generators pick the band from sampleIndex / total
+    
+    AdaptiveCandidate candidate;
+    if (typeIdx < classicDatasetTypes) {
+        candidate.dataset = generateByType(types[typeIdx], band, 3);
+        candidate.typeName = getTypeName(types[typeIdx]);
+    } else {
+        const Workload& workload = workloads[typeIdx - classicDatasetTypes];
+        candidate.dataset = generateWorkloadSample(workload, band, 3);
+        candidate.typeName = workload.label.c_str();
+    }
+    candidate.features = extractFeatures(candidate.dataset);
+    return candidate;
+}
+
+int adaptiveGridCell(const Features& features) {  // Index of the coarse (size, sortedness, uniqueRatio) cell
+    int size = 0, sortedness = 0, unique = 0;
+    while (size < 3 && features.size >= ADAPTIVE_SIZE_EDGES[size]) size++;
+    while (sortedness < 5 && features.sortedness >= ADAPTIVE_SORTEDNESS_EDGES[sortedness]) sortedness++;
+    while (unique < 3 && features.uniqueRatio >= ADAPTIVE_UNIQUE_EDGES[unique]) unique++;
+    return (size * 6 + sortedness) * 4 + unique;
+}
+
+int adaptiveSampling(const string& outputFile, uint64_t seed, int sampleBudget, double secondsBudget,
+                     double targetAccuracy) {  // Label until the window accuracy, the sample budget or the time budget is reached
+    ofstream file(outputFile);
+    if (!file.is_open()) {
+        cerr << "Error: Cannot create output file: " << outputFile << endl;
+        return 1;
+    }
+    writeHeader(file);
+    
+    cout << "Adaptive sampling into " << outputFile << " (seed " << seed << ")" << endl;
+    cout << "Stops at " << fixed << setprecision(1) << targetAccuracy * 100 << "% accuracy over the last "
+         << ADAPTIVE_WINDOW << " points, " << sampleBudget << " samples";
+    if (secondsBudget > 0) {
+        cout << " or " << secondsBudget << " seconds";
+    }
+    cout << endl;
+    
+    KNNPredictor predictor(5);
+    long long startNs = monotonicNs();
+    int labelled = 0;
+    deque<bool> window;  // Test-then-train hits on the random picks
+    int windowHits = 0;
+    
+    auto label = [&](AdaptiveCandidate& candidate, bool random) {  // Race, score the model's guess, then learn the point
+        RaceOutcome best = findBestAlgorithm(candidate.dataset);
+        writeRow(file, candidate.features, best, candidate.typeName);
+        
+        if (random) {
+            bool hit = best.accepts(predictor.predict(candidate.features));
+            window.push_back(hit);
+            windowHits += hit;
+            if ((int)window.size() > ADAPTIVE_WINDOW) {
+                windowHits -= window.front();
+                window.pop_front();
+            }
+        }
+        predictor.addTrainingData(candidate.features, best.winner);
+        labelled++;
+    };
+    auto windowAccuracy = [&]() {
+        return window.empty() ? 0.0 : (double)windowHits / window.size();
+    };
+    auto outOfTime = [&]() {
+        return secondsBudget > 0 && (monotonicNs() - startNs) / 1e9 >= secondsBudget;
+    };
+    
+    // Seed: the first dataset to land in each grid cell, so no region the generators reach starts unknown
+    set<int> coveredCells;
+    for (int i = 0; i < ADAPTIVE_SEED_DRAWS && labelled < sampleBudget && !outOfTime(); i++) {
+        AdaptiveCandidate candidate = drawAdaptiveCandidate();
+        if (coveredCells.insert(adaptiveGridCell(candidate.features)).second) {
+            label(candidate, false);
+        }
+    }
+    int gridSamples = labelled;
+    cout << "  Grid: " << gridSamples << " cells" << endl;
+    
+    string stopReason = "sample budget";
+    while (labelled < sampleBudget) {
+        if (outOfTime()) {
+            stopReason = "time budget";
+            break;
+        }
+        if ((int)window.size() >= ADAPTIVE_WINDOW && windowAccuracy() >= targetAccuracy) {
+            stopReason = "target accuracy";
+            break;
+        }
+        
+        // Score a fresh pool; the neighbours disagree most where confidence is lowest
+        vector<AdaptiveCandidate> pool(ADAPTIVE_CANDIDATES);
+        for (AdaptiveCandidate& candidate : pool) {
+            candidate = drawAdaptiveCandidate();
+            predictor.predict(candidate.features, candidate.confidence);
+        }
+        int uncertain = ADAPTIVE_BATCH - ADAPTIVE_EXPLORE;
+        partial_sort(pool.begin(), pool.begin() + uncertain, pool.end(),
+                     [](const AdaptiveCandidate& a, const AdaptiveCandidate& b) { return a.confidence < b.confidence; });
+        for (int i = uncertain; i < ADAPTIVE_BATCH; i++) {
+            swap(pool[i], pool[i + gen.bounded(ADAPTIVE_CANDIDATES - i)]);
+        }
+        
+        for (int i = 0; i < ADAPTIVE_BATCH && labelled < sampleBudget; i++) {
+            label(pool[i], i >= uncertain);
+        }
+        cout << "\r  Labelled: " << labelled << ", accuracy on the last " << window.size() << " random picks: "
+             << fixed << setprecision(1) << windowAccuracy() * 100 << "%   ";
+        cout.flush();
     }
+    file.close();
     
-    return fastest;
+    cout << "\nStopped on " << stopReason << " after " << labelled << " timing races (" << gridSamples << " grid, "
+         << labelled - gridSamples << " adaptive) in " << fixed << setprecision(1) << (monotonicNs() - startNs) / 1e9
+         << " seconds" << endl;
+    return 0;
 }
 
 
@@ -175,25 +562,103 @@ int main(int argc, char* argv[]) {  // Generate training data by testing sorting
     int samplesPerType = 1000;  // 1000 samples per dataset type
     string outputFile = "training_data.csv";
     
-
-    if (argc > 1) {
-        samplesPerType = atoi(argv[1]);
+    // Replay mode: --replay <corpus> [output.csv] [typed] labels captured production arrays instead of generating
+    if (argc > 2 && string(argv[1]) == "--replay") {
+        return replayCorpus(argv[2], argc > 3 ? argv[3] : outputFile, argc > 4 && string(argv[4]) == "typed");
+    }
+    
+    // Adaptive mode: --adaptive [output.csv] [seed] [--budget N] [--seconds S] [--target A] races only where k-NN is unsure
+    if (argc > 1 && string(argv[1]) == "--adaptive") {
+        int sampleBudget = 2000;
+        double secondsBudget = 0;  // 0 = no time limit
+        double targetAccuracy = 0.9;
+        vector<string> arguments;
+        for (int i = 2; i < argc; i++) {
+            string option = argv[i];
+            if (option == "--budget" && i + 1 < argc) {
+                sampleBudget = max(1, atoi(argv[++i]));
+            } else if (option == "--seconds" && i + 1 < argc) {
+                secondsBudget = atof(argv[++i]);
+            } else if (option == "--target" && i + 1 < argc) {
+                targetAccuracy = atof(argv[++i]);
+            } else {
+                arguments.push_back(option);
+            }
+        }
+        uint64_t seed = arguments.size() > 1 ? strtoull(arguments[1].c_str(), nullptr, 10) : freshSeed();
+        gen = Xoshiro256(seed);
+        return adaptiveSampling(arguments.size() > 0 ? arguments[0] : outputFile, seed, sampleBudget, secondsBudget,
+                                targetAccuracy);
+    }
+    
+    // Options may appear anywhere; the rest are positional: samples per type, output file, "typed", seed
+    int workerCount = 1;    // --workers N: 1 = sequential on the calling thread, 0 = one per unreserved core
+    int reservedCores = 1;  // --reserve N: cores left to the producer, the writer and the OS in parallel mode
+    vector<string> positional;
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--workers" && i + 1 < argc) {
+            workerCount = atoi(argv[++i]);
+        } else if (option == "--reserve" && i + 1 < argc) {
+            reservedCores = max(0, atoi(argv[++i]));
+        } else {
+            positional.push_back(option);
+        }
     }
-    if (argc > 2) {
-        outputFile = argv[2];
+    
+    if (positional.size() > 0) {
+        samplesPerType = atoi(positional[0].c_str());
+    }
+    if (positional.size() > 1) {
+        outputFile = positional[1];
+    }
+    // Third argument "typed": also race int64, double and string copies of every dataset
+    bool typedSamples = positional.size() > 2 && positional[2] == "typed";
+    // Fourth argument: the seed; the same seed and arguments reproduce the same datasets
+    uint64_t seed = positional.size() > 3 ? strtoull(positional[3].c_str(), nullptr, 10) : freshSeed();
+    gen = Xoshiro256(seed);
+    
+    // Parallel mode: the first reservedCores allowed CPUs host this thread, workers get one CPU each of the rest
+    vector<int> workerCpus;
+    if (workerCount != 1) {
+        vector<int> cpus = allowedCpus();
+        int reserved = min((int)cpus.size(), reservedCores);
+        workerCpus.assign(cpus.begin() + reserved, cpus.end());
+        if (workerCount > 1 && (int)workerCpus.size() > workerCount) {
+            workerCpus.resize(workerCount);
+        }
+        if (workerCpus.empty()) {
+            cout << "[WARN] No core left after reserving " << reservedCores << "; generating sequentially." << endl;
+        } else if (reserved > 0) {
+            pinCurrentThread(vector<int>(cpus.begin(), cpus.begin() + reserved));
+        }
     }
     
 
-    int totalDatasetTypes = 5;
+    const int classicDatasetTypes = 5;
+    const vector<Workload>& workloads = getWorkloads();
+    int totalDatasetTypes = classicDatasetTypes + workloads.size();
     int totalSamples = samplesPerType * totalDatasetTypes;
     
     cout << "========================================" << endl;
     cout << "  k-NN Training Data Generator v2.0" << endl;
     cout << "========================================" << endl;
     cout << "Strategy: Generate " << samplesPerType << " samples per dataset type" << endl;
-    cout << "Dataset types: Random, NearlySorted, Reversed, FewUnique, LargeRandom" << endl;
+    cout << "Dataset types: Random, NearlySorted, Reversed, FewUnique, LargeRandom";
+    for (const Workload& workload : workloads) {
+        cout << ", " << workload.label;
+    }
+    cout << endl;
     cout << "Total samples: " << totalSamples << endl;
     cout << "Output file: " << outputFile << endl;
+    cout << "Seed: " << seed << endl;
+    if (typedSamples) {
+        cout << "Typed samples: int64, double and string rows per dataset" << endl;
+    }
+    if (!workerCpus.empty()) {
+        cout << "Workers: " << workerCpus.size() << " pinned to CPUs " << workerCpus.front() << "-" << workerCpus.back()
+             << ", " << reservedCores << " reserved; the Parallel* kernels are not raced" << endl;
+    }
     cout << endl;
     
     // Open output file
@@ -203,39 +668,39 @@ int main(int argc, char* argv[]) {  // Generate training data by testing sorting
         return 1;
     }
     
-    file << "size,sortedness,uniqueRatio,bestAlgorithm,datasetType" << endl;
+    writeHeader(file);
     
     time_t startTime = time(nullptr);
     int totalGenerated = 0;
     
+    // Datasets are still drawn here in order, so the seed fixes every dataset and its row position
+    unique_ptr<SamplePipeline> pipeline;
+    if (!workerCpus.empty()) {
+        pipeline.reset(new SamplePipeline(file, typedSamples, workerCpus));
+    }
+    
 
     DatasetType types[] = {TYPE_RANDOM, TYPE_NEARLY_SORTED, TYPE_REVERSED, 
                            TYPE_FEW_UNIQUE, TYPE_LARGE_RANDOM};
     
     for (int typeIdx = 0; typeIdx < totalDatasetTypes; typeIdx++) {
-        DatasetType currentType = types[typeIdx];
-        const char* typeName = getTypeName(currentType);
+        // The classic types first, then every registered workload
+        const Workload* workload = typeIdx < classicDatasetTypes ? nullptr : &workloads[typeIdx - classicDatasetTypes];
+        const char* typeName = workload != nullptr ? workload->label.c_str() : getTypeName(types[typeIdx]);
         
         cout << "\n[" << (typeIdx + 1) << "/" << totalDatasetTypes << "] ";
         cout << "Generating " << samplesPerType << " samples for: " << typeName << endl;
         
         for (int i = 0; i < samplesPerType; i++) {
-            vector<int> dataset = generateByType(currentType, i, samplesPerType);
+            vector<int> dataset = workload != nullptr ? generateWorkloadSample(*workload, i, samplesPerType)
+                                                      : generateByType(types[typeIdx], i, samplesPerType);
             
 
-            int actualSize = getDatasetSize(dataset);
-            double actualSortedness = calculateSortedness(dataset);
-            double actualUniqueRatio = calculateUniqueRatio(dataset);
-            
-
-            string bestAlgorithm = findBestAlgorithm(dataset);
-            
-
-            file << actualSize << ","
-                 << fixed << setprecision(2) << actualSortedness << ","
-                 << fixed << setprecision(4) << actualUniqueRatio << ","
-                 << bestAlgorithm << ","
-                 << typeName << endl;
+            if (pipeline) {
+                pipeline->submit(dataset, typeName);
+            } else {
+                writeSample(file, dataset, typeName, typedSamples);
+            }
             
             totalGenerated++;
             
@@ -257,6 +722,9 @@ int main(int argc, char* argv[]) {  // Generate training data by testing sorting
         cout << " [OK]" << endl;
     }
     
+    if (pipeline) {
+        pipeline->finish();
+    }
     file.close();
     
     time_t endTime = time(nullptr);
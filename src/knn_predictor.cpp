@@ -9,15 +9,39 @@ using namespace std;
 
 
 
+const char* getKeyTypeName(KeyType type) {  // Name used in CSV files and on the command line
+    switch (type) {
+        case KEY_INT32: return "int32";
+        case KEY_INT64: return "int64";
+        case KEY_FLOAT: return "float";
+        case KEY_DOUBLE: return "double";
+        case KEY_STRING: return "string";
+        default: return "unknown";
+    }
+}
+
+bool parseKeyType(const string& name, KeyType& type) {  // Accept exactly the names getKeyTypeName produces
+    const KeyType types[] = {KEY_INT32, KEY_INT64, KEY_FLOAT, KEY_DOUBLE, KEY_STRING};
+    for (KeyType candidate : types) {
+        if (name == getKeyTypeName(candidate)) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+
 KNNPredictor::KNNPredictor(int kValue) : k(kValue) {}  // Initialize with k neighbors
 
 
 
 double KNNPredictor::euclideanDistance(const Features& f1, const Features& f2) {  // Calculate normalized Euclidean distance
     // Normalize all features to [0, 1] range for fair comparison
-    // Size: divide by 10000 (typical max dataset size)
-    double sizeNorm1 = f1.size / 10000.0;
-    double sizeNorm2 = f2.size / 10000.0;
+    // Size: log scale, a quarter per decade (10 keys -> 0.25, 10^4 -> 1); linear size let it outvote every other feature
+    double sizeNorm1 = log10(max(f1.size, 1)) / 4.0;
+    double sizeNorm2 = log10(max(f2.size, 1)) / 4.0;
     // Sortedness: already in 0-100%, convert to 0-1
     double sortNorm1 = f1.sortedness / 100.0;
     double sortNorm2 = f2.sortedness / 100.0;
@@ -26,11 +50,27 @@ double KNNPredictor::euclideanDistance(const Features& f1, const Features& f2) {
     double uniqueNorm2 = f2.uniqueRatio;
     
     // Calculate Euclidean distance: sqrt(sum of squared differences)
+    // Estimated features only place the dataset within their margins; differences inside them do not count
     double sizeDiff = sizeNorm1 - sizeNorm2;
-    double sortDiff = sortNorm1 - sortNorm2;
-    double uniqueDiff = uniqueNorm1 - uniqueNorm2;
+    double sortDiff = max(0.0, fabs(sortNorm1 - sortNorm2) - (f1.sortednessMargin + f2.sortednessMargin) / 100.0);
+    double uniqueDiff = max(0.0, fabs(uniqueNorm1 - uniqueNorm2) - (f1.uniqueRatioMargin + f2.uniqueRatioMargin));
+    double squared = sizeDiff * sizeDiff + sortDiff * sortDiff + uniqueDiff * uniqueDiff;
+    
+    // Shape dimensions, when both samples were scanned for them; all are ratios in [0, 1] except the
+    // value range, which spans orders of magnitude and is compared on a log scale (2^-8 .. 2^8 -> 0 .. 1)
+    if (f1.hasShape && f2.hasShape) {
+        double runDiff = f1.runRatio - f2.runRatio;
+        double longestDiff = f1.longestRunRatio - f2.longestRunRatio;
+        double descendingDiff = f1.descendingRatio - f2.descendingRatio;
+        double inversionDiff = f1.inversionRatio - f2.inversionRatio;
+        double rangeNorm1 = max(0.0, min(1.0, log2(max(f1.rangeRatio, 1e-9)) / 16.0 + 0.5));
+        double rangeNorm2 = max(0.0, min(1.0, log2(max(f2.rangeRatio, 1e-9)) / 16.0 + 0.5));
+        double rangeDiff = rangeNorm1 - rangeNorm2;
+        squared += runDiff * runDiff + longestDiff * longestDiff + descendingDiff * descendingDiff
+                 + inversionDiff * inversionDiff + rangeDiff * rangeDiff;
+    }
     
-    return sqrt(sizeDiff * sizeDiff + sortDiff * sortDiff + uniqueDiff * uniqueDiff);
+    return sqrt(squared);
 }
 
 
@@ -39,7 +79,7 @@ void KNNPredictor::addTrainingData(Features features, string bestAlgorithm) {  /
     trainingData.push_back(DataPoint(features, bestAlgorithm));
 }
 
-void KNNPredictor::loadDefaultTrainingData() {  // Load 26 pre-defined training samples
+void KNNPredictor::loadDefaultTrainingData() {  // Load 26 int32 samples plus 21 for the other key types
     trainingData.clear();
     
 
@@ -53,7 +93,8 @@ void KNNPredictor::loadDefaultTrainingData() {  // Load 26 pre-defined training
     addTrainingData(Features(50, 10, 1.0), "Merge");
     addTrainingData(Features(80, 5, 0.95), "Merge");
     
-    addTrainingData(Features(60, 48, 0.15), "Quick");
+    // Measured on generateFewUnique arrays: Counting won 5 of 5 races for every Counting row below
+    addTrainingData(Features(60, 48, 0.15), "Counting");
     
 
     
@@ -64,40 +105,88 @@ void KNNPredictor::loadDefaultTrainingData() {  // Load 26 pre-defined training
     addTrainingData(Features(500, 48, 0.90), "Quick");
     addTrainingData(Features(800, 52, 0.88), "Quick");
     
-    addTrainingData(Features(300, 0, 1.0), "Merge");
-    addTrainingData(Features(500, 5, 0.98), "Merge");
+    // Measured on generateReversed / generateNearlySorted arrays: Tim won 5 of 5 races for every Tim row below
+    addTrainingData(Features(300, 0, 1.0), "Tim");
+    addTrainingData(Features(500, 0, 1.0), "Tim");
     
-    addTrainingData(Features(400, 45, 0.10), "Quick");
-    addTrainingData(Features(600, 50, 0.08), "Quick");
+    addTrainingData(Features(400, 45, 0.10), "Counting");
+    addTrainingData(Features(600, 50, 0.08), "Counting");
     
 
     
-    addTrainingData(Features(2000, 85, 1.0), "Merge");
-    addTrainingData(Features(5000, 88, 0.99), "Merge");
+    addTrainingData(Features(2000, 99.5, 1.0), "Tim");
+    addTrainingData(Features(5000, 99.6, 1.0), "Tim");
     
-    addTrainingData(Features(2000, 50, 0.98), "Quick");
-    addTrainingData(Features(5000, 48, 0.95), "Quick");
-    addTrainingData(Features(10000, 51, 0.92), "Quick");
+    // Measured: Radix won 5 of 5 races at each of these (raceSortAlgorithms, 5 seeds per row)
+    addTrainingData(Features(2000, 50, 0.98), "Radix");
+    addTrainingData(Features(5000, 48, 0.95), "Radix");
+    addTrainingData(Features(10000, 51, 0.92), "Radix");
     
-    addTrainingData(Features(2000, 2, 1.0), "Merge");
-    addTrainingData(Features(5000, 0, 0.99), "Merge");
+    addTrainingData(Features(2000, 0, 1.0), "Tim");
+    addTrainingData(Features(5000, 0, 1.0), "Tim");
     
-    addTrainingData(Features(3000, 49, 0.20), "Quick");
-    addTrainingData(Features(8000, 50, 0.15), "Quick");
+    addTrainingData(Features(3000, 49, 0.20), "Counting");
+    addTrainingData(Features(8000, 50, 0.15), "Counting");
+    
+    addTrainingData(Features(10000, 50, 0.05), "Counting");
+    
+
+    // Other key types: radix on the ordered bit image wins unless the keys are already in order
+    addTrainingData(Features(300, 50, 0.98, KEY_INT64), "Radix");
+    addTrainingData(Features(5000, 50, 0.05, KEY_INT64), "Radix");
+    addTrainingData(Features(20000, 50, 0.95, KEY_INT64), "Radix");
+    addTrainingData(Features(200000, 50, 0.95, KEY_INT64), "Radix");
+    addTrainingData(Features(5000, 100, 1.0, KEY_INT64), "Merge");
     
-    addTrainingData(Features(10000, 50, 0.05), "Quick");
+    addTrainingData(Features(300, 50, 0.98, KEY_DOUBLE), "Radix");
+    addTrainingData(Features(5000, 50, 0.05, KEY_DOUBLE), "Radix");
+    addTrainingData(Features(20000, 50, 0.95, KEY_DOUBLE), "Radix");
+    addTrainingData(Features(200000, 50, 0.95, KEY_DOUBLE), "Radix");
+    addTrainingData(Features(5000, 100, 1.0, KEY_DOUBLE), "Merge");
+    
+    addTrainingData(Features(300, 50, 0.98, KEY_FLOAT), "Radix");
+    addTrainingData(Features(5000, 50, 0.05, KEY_FLOAT), "Radix");
+    addTrainingData(Features(20000, 50, 0.95, KEY_FLOAT), "Radix");
+    addTrainingData(Features(200000, 50, 0.95, KEY_FLOAT), "Radix");
+    addTrainingData(Features(5000, 100, 1.0, KEY_FLOAT), "Merge");
+    
+    // Strings: multikey quicksort skips shared prefixes; merge only wins on sorted input
+    addTrainingData(Features(2000, 50, 1.0, KEY_STRING), "MultikeyQuick");
+    addTrainingData(Features(5000, 50, 0.10, KEY_STRING), "MultikeyQuick");
+    addTrainingData(Features(20000, 50, 1.0, KEY_STRING), "MultikeyQuick");
+    addTrainingData(Features(200000, 50, 1.0, KEY_STRING), "MultikeyQuick");
+    addTrainingData(Features(5000, 100, 1.0, KEY_STRING), "Merge");
+    addTrainingData(Features(200000, 100, 1.0, KEY_STRING), "Merge");
 }
 
 
 
 string KNNPredictor::predict(const Features& features) {  // Predict using k nearest neighbors voting
+    double confidence;
+    return predict(features, confidence);
+}
+
+string KNNPredictor::predict(const Features& features, double& confidence) {  // Majority vote and its share of the k votes
+    confidence = 0.0;
     if (trainingData.empty()) {
         return "Quick";  // Default fallback if no training data
     }
     
+    // Each key type is its own model; a type with no samples falls back to all of them
+    bool typeTrained = false;
+    for (const DataPoint& dp : trainingData) {
+        if (dp.features.keyType == features.keyType) {
+            typeTrained = true;
+            break;
+        }
+    }
+    
     // Step 1: Calculate distance to all training points
     vector<Neighbor> neighbors;
     for (const DataPoint& dp : trainingData) {
+        if (typeTrained && dp.features.keyType != features.keyType) {
+            continue;
+        }
         double dist = euclideanDistance(features, dp.features);
         neighbors.push_back(Neighbor(dist, dp.bestAlgorithm));
     }
@@ -127,6 +216,9 @@ string KNNPredictor::predict(const Features& features) {  // Predict using k nea
         }
     }
     
+    if (consideredK > 0) {
+        confidence = (double)maxVotes / consideredK;
+    }
     return bestAlgorithm;
 }
 
@@ -161,22 +253,42 @@ bool KNNPredictor::loadTrainingDataFromFile(const string& filename) {  // Load t
     int lineCount = 0;
     while (getline(file, line)) {
         stringstream ss(line);
-        string sizeStr, sortStr, uniqueStr, algorithm, datasetType;
+        string sizeStr, sortStr, uniqueStr, algorithm, datasetType, keyTypeStr;
         
         if (getline(ss, sizeStr, ',') &&
             getline(ss, sortStr, ',') &&
             getline(ss, uniqueStr, ',') &&
             getline(ss, algorithm, ',')) {
             
-            getline(ss, datasetType);
+            getline(ss, datasetType, ',');
+            getline(ss, keyTypeStr, ',');
+            
+            // Optional shape columns: runRatio,longestRunRatio,descendingRatio,rangeRatio,inversionRatio
+            vector<string> shapeStr(5);
+            for (string& field : shapeStr) {
+                getline(ss, field, ',');
+            }
             
             try {
                 int size = stoi(sizeStr);
                 double sortedness = stod(sortStr);
                 double uniqueRatio = stod(uniqueStr);
                 
+                // Files without the keyType column hold int32 samples
+                KeyType keyType = KEY_INT32;
+                if (!keyTypeStr.empty() && !parseKeyType(keyTypeStr, keyType)) {
+                    continue;
+                }
 
-                Features features(size, sortedness, uniqueRatio);
+                Features features(size, sortedness, uniqueRatio, keyType);
+                if (!shapeStr[4].empty()) {
+                    features.hasShape = true;
+                    features.runRatio = stod(shapeStr[0]);
+                    features.longestRunRatio = stod(shapeStr[1]);
+                    features.descendingRatio = stod(shapeStr[2]);
+                    features.rangeRatio = stod(shapeStr[3]);
+                    features.inversionRatio = stod(shapeStr[4]);
+                }
                 addTrainingData(features, algorithm);
                 lineCount++;
             } catch (...) {
@@ -195,13 +307,24 @@ bool KNNPredictor::saveTrainingDataToFile(const string& filename) const {  // Sa
         return false;
     }
     
-    file << "size,sortedness,uniqueRatio,bestAlgorithm" << endl;
+    file << "size,sortedness,uniqueRatio,bestAlgorithm,datasetType,keyType,"
+         << "runRatio,longestRunRatio,descendingRatio,rangeRatio,inversionRatio" << endl;
     
+    // The dataset type is not kept per sample; the column stays empty. So do the shape columns of unscanned samples
     for (const DataPoint& dp : trainingData) {
-        file << dp.features.size << ","
-             << dp.features.sortedness << ","
-             << dp.features.uniqueRatio << ","
-             << dp.bestAlgorithm << endl;
+        const Features& f = dp.features;
+        file << f.size << ","
+             << f.sortedness << ","
+             << f.uniqueRatio << ","
+             << dp.bestAlgorithm << ","
+             << ","
+             << getKeyTypeName(f.keyType);
+        if (f.hasShape) {
+            file << "," << f.runRatio << "," << f.longestRunRatio << "," << f.descendingRatio
+                 << "," << f.rangeRatio << "," << f.inversionRatio << endl;
+        } else {
+            file << ",,,,," << endl;
+        }
     }
     
     file.close();
@@ -34,47 +34,61 @@ void displayFeatures(const Features& features) {  // Display extracted dataset f
     cout << "  Size:          " << features.size << " elements" << endl;
     cout << "  Sortedness:    " << fixed << setprecision(2) << features.sortedness << "%" << endl;
     cout << "  Unique Ratio:  " << fixed << setprecision(4) << features.uniqueRatio << endl;
+    if (features.hasShape) {
+        cout << "  Runs / Size:   " << fixed << setprecision(4) << features.runRatio << endl;
+        cout << "  Longest Run:   " << fixed << setprecision(4) << features.longestRunRatio << " of the array" << endl;
+        cout << "  Descending:    " << fixed << setprecision(4) << features.descendingRatio << endl;
+        cout << "  Range / Size:  " << fixed << setprecision(4) << features.rangeRatio << endl;
+        cout << "  Inversions:    " << fixed << setprecision(4) << features.inversionRatio << " (sampled)" << endl;
+    }
 }
 
 void displayPrediction(const string& prediction) {  // Display k-NN prediction result
     cout << "\n--- k-NN Prediction ---" << endl;
-    cout << "  Predicted Best Algorithm: " << prediction << " Sort" << endl;
+    cout << "  Predicted Best Algorithm: " << prediction << endl;
 }
 
-void displayResults(const vector<SortResult>& results, const string& prediction) {  // Display sorting performance comparison table
+void displayResults(const vector<SortResult>& results, const vector<string>& labels, const string& prediction) {  // Display sorting performance comparison table
     cout << "\n--- Sorting Performance Results ---" << endl;
-    cout << left << setw(18) << "Algorithm" 
+    cout << left << setw(22) << "Algorithm" 
          << right << setw(15) << "Comparisons" 
+         << setw(15) << "Moves" 
          << setw(15) << "Time (ms)" 
+         << setw(15) << "CPU (ms)" 
          << setw(12) << "Predicted" << endl;
-    cout << string(60, '-') << endl;
+    cout << string(94, '-') << endl;
     
     // Find the fastest algorithm
     double minTime = results[0].timeMs;
+    string fastestLabel = labels[0];
     string fastestAlgo = results[0].algorithmName;
-    for (const auto& result : results) {
-        if (result.timeMs < minTime) {
-            minTime = result.timeMs;
-            fastestAlgo = result.algorithmName;
+    for (size_t i = 0; i < results.size(); i++) {
+        if (results[i].timeMs < minTime) {
+            minTime = results[i].timeMs;
+            fastestLabel = labels[i];
+            fastestAlgo = results[i].algorithmName;
         }
     }
     
-    for (const auto& result : results) {
-        cout << left << setw(18) << result.algorithmName
+    for (size_t i = 0; i < results.size(); i++) {
+        const SortResult& result = results[i];
+        cout << left << setw(22) << result.algorithmName
              << right << setw(15) << result.comparisons
-             << setw(15) << fixed << setprecision(3) << result.timeMs;
+             << setw(15) << result.moves
+             << setw(15) << fixed << setprecision(3) << result.timeMs
+             << setw(15) << fixed << setprecision(3) << result.cpuTimeMs;
         
-        string predicted = (prediction + " Sort" == result.algorithmName) ? "[YES]" : "";
-        string fastest = (result.algorithmName == fastestAlgo) ? " [FASTEST]" : "";
+        string predicted = (labels[i] == prediction) ? "[YES]" : "";
+        string fastest = (labels[i] == fastestLabel) ? " [FASTEST]" : "";
         cout << setw(12) << predicted << fastest << endl;
     }
     
 
     cout << "\n--- Prediction Validation ---" << endl;
-    if (prediction + " Sort" == fastestAlgo) {
+    if (prediction == fastestLabel) {
         cout << "  [OK] k-NN prediction is CORRECT! Predicted the fastest algorithm." << endl;
     } else {
-        cout << "  [WARN] k-NN predicted: " << prediction << " Sort" << endl;
+        cout << "  [WARN] k-NN predicted: " << prediction << endl;
         cout << "  [WARN] Actual fastest: " << fastestAlgo << endl;
     }
 }
@@ -87,7 +101,7 @@ int main() {  // Main program entry point
     KNNPredictor predictor(5);
     
     cout << "--- Training Data Options ---" << endl;
-    cout << "1. Use default training data (26 hardcoded samples)" << endl;
+    cout << "1. Use default training data (47 hardcoded samples)" << endl;
     cout << "2. Load training data from file (recommended: ~1000 samples)" << endl;
     cout << "\nEnter your choice: ";
     
@@ -189,11 +203,7 @@ int main() {  // Main program entry point
         }
         
 
-        Features features(
-            getDatasetSize(dataset),
-            calculateSortedness(dataset),
-            calculateUniqueRatio(dataset)
-        );
+        Features features = extractFeatures(dataset);
         
         displayFeatures(features);
         
@@ -203,32 +213,25 @@ int main() {  // Main program entry point
         
 
         vector<SortResult> results;
+        vector<string> labels;
         
 
-        bool skipSlow = dataset.size() > 1000;
-        
-        if (!skipSlow) {
-            cout << "\nRunning Bubble Sort..." << endl;
-            vector<int> arr1 = copyArray(dataset);
-            results.push_back(bubbleSort(arr1));
-            
-            cout << "Running Insertion Sort..." << endl;
-            vector<int> arr2 = copyArray(dataset);
-            results.push_back(insertionSort(arr2));
-        } else {
-            cout << "\n[WARN] Skipping Bubble and Insertion Sort (array too large)" << endl;
+        for (const SortAlgorithm& algorithm : getSortAlgorithms()) {
+            if (!algorithm.appliesTo(dataset.size())) {
+                if (algorithm.maxSize > 0 && (int)dataset.size() > algorithm.maxSize) {
+                    cout << "[WARN] Skipping " << algorithm.label << " (array too large)" << endl;
+                }
+                continue;
         }
         
-        cout << "Running Merge Sort..." << endl;
-        vector<int> arr3 = copyArray(dataset);
-        results.push_back(mergeSort(arr3));
-        
-        cout << "Running Quick Sort..." << endl;
-        vector<int> arr4 = copyArray(dataset);
-        results.push_back(quickSort(arr4));
+            cout << "Running " << algorithm.label << "..." << endl;
+            vector<int> arr = copyArray(dataset);
+            results.push_back(algorithm.run(arr));
+            labels.push_back(algorithm.label);
+        }
         
 
-        displayResults(results, prediction);
+        displayResults(results, labels, prediction);
     }
     
     return 0;
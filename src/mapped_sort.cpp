@@ -0,0 +1,196 @@
+#include "../include/mapped_sort.h"
+#include "../include/sorting_algorithms.h"
+#include "../include/dataset.h"
+#include "../include/typed_sort.h"
+#include "../include/corpus.h"
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+using namespace chrono;
+
+
+
+const int MAPPED_FEATURE_SAMPLE_SIZE = 4096;  // Keys sampled for the unique ratio
+
+
+
+static double elapsedMs(high_resolution_clock::time_point start) {  // Milliseconds since start
+    return duration_cast<microseconds>(high_resolution_clock::now() - start).count() / 1000.0;
+}
+
+static bool accessesRandomly(const string& label) {  // Partition-based kernels jump around; the rest stream
+    return label == "Quick" || label == "SimdQuick" || label == "ThreeWayQuick" || label == "ParallelQuick";
+}
+
+
+
+static size_t keySize(KeyType keyType) {  // Bytes per key in the file
+    return keyType == KEY_INT64 || keyType == KEY_DOUBLE ? 8 : 4;
+}
+
+static void sortMappedKeys(int* data, int n, KNNPredictor& predictor, MappedSortStats& stats) {  // int32: the full registry
+    captureSortInput(data, n, "mappedSort");
+    
+    auto featureStart = high_resolution_clock::now();
+    Features features = n >= SAMPLED_FEATURE_MIN_SIZE ? sampleFeatures(data, n) : extractFeatures(data, n);
+    stats.sortedness = features.sortedness;
+    stats.uniqueRatio = features.uniqueRatio;
+    stats.sortednessMargin = features.sortednessMargin;
+    stats.uniqueRatioMargin = features.uniqueRatioMargin;
+    string label = predictor.predict(features);
+    stats.featureMs = elapsedMs(featureStart);
+    
+    const SortAlgorithm* algorithm = findSortAlgorithm(label);
+    if (algorithm == nullptr || !algorithm->appliesTo(n)) {
+        algorithm = findSortAlgorithm("Quick");
+    }
+    stats.algorithm = algorithm->label;
+    
+    auto sortStart = high_resolution_clock::now();
+    madvise(data, (size_t)n * sizeof(int), accessesRandomly(algorithm->label) ? MADV_RANDOM : MADV_SEQUENTIAL);
+    algorithm->kernel(data, n);
+    stats.sortMs = elapsedMs(sortStart);
+}
+
+template <class Key>
+static void sortMappedKeys(Key* data, int n, KNNPredictor& predictor, MappedSortStats& stats) {  // Other key types: the typed engines
+    auto featureStart = high_resolution_clock::now();
+    stats.sortedness = calculateSortedness(data, n);
+    stats.uniqueRatio = sampleUniqueRatio(data, n, MAPPED_FEATURE_SAMPLE_SIZE);
+    stats.algorithm = predictor.predict(Features(n, stats.sortedness, stats.uniqueRatio, keyTypeOf<Key>()));
+    stats.featureMs = elapsedMs(featureStart);
+    
+    auto sortStart = high_resolution_clock::now();
+    madvise(data, (size_t)n * sizeof(Key), accessesRandomly(stats.algorithm) ? MADV_RANDOM : MADV_SEQUENTIAL);
+    typedSortKernel(data, n, stats.algorithm);
+    stats.sortMs = elapsedMs(sortStart);
+}
+
+
+
+bool mappedSort(const string& inputFile, const string& outputFile, MappedSortMode mode,
+                KNNPredictor& predictor, MappedSortStats& stats, KeyType keyType) {  // Map, extract features, sort, sync
+    stats = MappedSortStats();
+    if (keyType == KEY_STRING) {
+        stats.error = "string keys have no fixed-width file format";
+        return false;
+    }
+    size_t keyBytes = keySize(keyType);
+    auto mapStart = high_resolution_clock::now();
+    
+    int inputFd = open(inputFile.c_str(), mode == MAPPED_IN_PLACE ? O_RDWR : O_RDONLY);
+    if (inputFd < 0) {
+        stats.error = "cannot open " + inputFile;
+        return false;
+    }
+    struct stat info;
+    if (fstat(inputFd, &info) != 0 || info.st_size % keyBytes != 0) {
+        close(inputFd);
+        stats.error = inputFile + " is not a whole number of " + getKeyTypeName(keyType) + " keys";
+        return false;
+    }
+    size_t bytes = info.st_size;
+    stats.elements = bytes / keyBytes;
+    if (stats.elements > INT_MAX) {
+        close(inputFd);
+        stats.error = inputFile + " has more keys than an in-memory sort can index; use the external sort";
+        return false;
+    }
+    
+    // No O_TRUNC: the output may be the input under another name, and must not be emptied before it is checked
+    int outputFd = -1;
+    if (mode == MAPPED_TO_OUTPUT) {
+        outputFd = open(outputFile.c_str(), O_RDWR | O_CREAT, 0644);
+        struct stat outputInfo;
+        if (outputFd < 0 || fstat(outputFd, &outputInfo) != 0) {
+            if (outputFd >= 0) close(outputFd);
+            close(inputFd);
+            stats.error = "cannot create " + outputFile;
+            return false;
+        }
+        if (outputInfo.st_dev == info.st_dev && outputInfo.st_ino == info.st_ino) {
+            close(inputFd);  // Same file: sort it in place through the writable descriptor
+            inputFd = outputFd;
+            outputFd = -1;
+            mode = MAPPED_IN_PLACE;
+        } else if (ftruncate(outputFd, bytes) != 0) {
+            close(outputFd);
+            close(inputFd);
+            stats.error = "cannot create " + outputFile;
+            return false;
+        }
+    }
+    
+    if (bytes == 0) {  // mmap rejects empty mappings; nothing to sort anyway
+        if (outputFd >= 0) close(outputFd);
+        close(inputFd);
+        stats.algorithm = "-";
+        stats.mapMs = elapsedMs(mapStart);
+        return true;
+    }
+    
+    // The mapping the kernel sorts: the input itself, a private view of it, or the output file
+    void* mapping = MAP_FAILED;
+    if (mode == MAPPED_IN_PLACE) {
+        mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, inputFd, 0);
+    } else if (mode == MAPPED_PRIVATE) {
+        mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, inputFd, 0);
+    } else {
+        mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, outputFd, 0);
+        if (mapping != MAP_FAILED) {
+            void* source = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, inputFd, 0);
+            if (source == MAP_FAILED) {
+                munmap(mapping, bytes);
+                mapping = MAP_FAILED;
+            } else {
+                madvise(source, bytes, MADV_SEQUENTIAL);
+                madvise(mapping, bytes, MADV_SEQUENTIAL);
+                memcpy(mapping, source, bytes);
+                munmap(source, bytes);
+            }
+        }
+    }
+    if (mapping == MAP_FAILED) {
+        if (outputFd >= 0) close(outputFd);
+        close(inputFd);
+        stats.error = "cannot map " + (mode == MAPPED_TO_OUTPUT ? outputFile : inputFile);
+        return false;
+    }
+    int n = stats.elements;
+    stats.mapMs = elapsedMs(mapStart);
+    
+    // Feature scan is one sequential pass; start readahead for all of it
+    madvise(mapping, bytes, MADV_SEQUENTIAL);
+    madvise(mapping, bytes, MADV_WILLNEED);
+    if (keyType == KEY_INT64) {
+        sortMappedKeys((long long*)mapping, n, predictor, stats);
+    } else if (keyType == KEY_FLOAT) {
+        sortMappedKeys((float*)mapping, n, predictor, stats);
+    } else if (keyType == KEY_DOUBLE) {
+        sortMappedKeys((double*)mapping, n, predictor, stats);
+    } else {
+        sortMappedKeys((int*)mapping, n, predictor, stats);
+    }
+    
+    auto syncStart = high_resolution_clock::now();
+    bool synced = true;
+    if (mode != MAPPED_PRIVATE) {
+        synced = msync(mapping, bytes, MS_SYNC) == 0;
+    }
+    munmap(mapping, bytes);
+    if (outputFd >= 0) close(outputFd);
+    close(inputFd);
+    stats.syncMs = elapsedMs(syncStart);
+    
+    if (!synced) {
+        stats.error = "cannot write back " + (mode == MAPPED_TO_OUTPUT ? outputFile : inputFile);
+        return false;
+    }
+    return true;
+}
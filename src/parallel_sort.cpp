@@ -0,0 +1,387 @@
+#include "../include/sorting_algorithms.h"
+#include "../include/thread_pool.h"
+#include <chrono>
+#include <ctime>
+#include <map>
+#include <algorithm>
+
+using namespace std;
+using namespace chrono;
+
+
+
+const int PARALLEL_SORT_GRAIN = 4096;   // Ranges up to this size are sorted by one thread
+const int PARALLEL_MERGE_GRAIN = 8192;  // Merges up to this many output elements run on one thread
+const int SEGMENT_TASK_GRAIN = 65536;   // Consecutive segments are batched into tasks of about this many keys
+const int SEGMENT_INSERTION_MAX = 8;    // Segment size buckets: insertion sort up to here,
+const int SEGMENT_NETWORK_MAX = 64;     //   sorting network up to here,
+const int SEGMENT_RADIX_MIN = 2048;     //   network blocks plus merging below here, LSD radix from here on
+
+
+
+template <class Counter>
+struct SharedCounter {  // Totals reported by parallel tasks, merged under a lock
+    mutex lock;
+    Counter total;
+    
+    void add(const Counter& local) {
+        lock_guard<mutex> guard(lock);
+        total.add(local);
+    }
+};
+
+template <>
+struct SharedCounter<NoCounter> {  // Nothing to merge when counting is off
+    NoCounter total;
+    
+    void add(const NoCounter&) {}
+};
+
+
+
+ThreadPool& getSortThreadPool(int threadCount) {  // Reuse one pool per thread count across calls
+    static mutex poolsLock;
+    static map<int, unique_ptr<ThreadPool> > pools;
+    
+    if (threadCount <= 0) {
+        threadCount = max(1, (int)thread::hardware_concurrency());
+    }
+    
+    lock_guard<mutex> guard(poolsLock);
+    unique_ptr<ThreadPool>& pool = pools[threadCount];
+    if (!pool) {
+        pool.reset(new ThreadPool(threadCount));
+    }
+    return *pool;
+}
+
+
+
+template <class Counter>
+int lowerBound(const int* data, int n, int value, Counter& counter) {  // First index with data[i] >= value
+    int low = 0, high = n;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        counter.compare();
+        if (data[mid] < value) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+template <class Counter>
+int upperBound(const int* data, int n, int value, Counter& counter) {  // First index with data[i] > value
+    int low = 0, high = n;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        counter.compare();
+        if (data[mid] <= value) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+template <class Counter>
+void parallelMerge(const int* left, int n1, const int* right, int n2, int* dst,
+                   TaskGroup& group, SharedCounter<Counter>& shared) {  // Stable merge of two sorted runs into dst
+    Counter local;
+    
+    if (n1 + n2 <= PARALLEL_MERGE_GRAIN) {
+        int i = 0, j = 0, k = 0;
+        while (i < n1 && j < n2) {
+            local.compare();
+            if (left[i] <= right[j]) dst[k++] = left[i++];
+            else dst[k++] = right[j++];
+        }
+        while (i < n1) dst[k++] = left[i++];
+        while (j < n2) dst[k++] = right[j++];
+        local.move(n1 + n2);
+        shared.add(local);
+        return;
+    }
+    
+    // Split the longer run at its midpoint and binary-search the split value in the other run.
+    // Ties go left-run-first on both halves, so the merge stays stable.
+    int leftSplit, rightSplit;
+    if (n1 >= n2) {
+        leftSplit = n1 / 2;
+        rightSplit = lowerBound(right, n2, left[leftSplit], local);
+    } else {
+        rightSplit = n2 / 2;
+        leftSplit = upperBound(left, n1, right[rightSplit], local);
+    }
+    shared.add(local);
+    
+    int* upperDst = dst + leftSplit + rightSplit;
+    group.run([=, &group, &shared] {
+        parallelMerge(left + leftSplit, n1 - leftSplit, right + rightSplit, n2 - rightSplit,
+                      upperDst, group, shared);
+    });
+    parallelMerge(left, leftSplit, right, rightSplit, dst, group, shared);
+}
+
+template <class Counter>
+void parallelMergeSortRange(int* data, int* buffer, int n, bool intoBuffer,
+                            ThreadPool& pool, SharedCounter<Counter>& shared) {  // Sort data[0, n); result in buffer if intoBuffer
+    if (n <= PARALLEL_SORT_GRAIN) {
+        Counter local;
+        mergeSortRange(data, buffer, n, local);
+        if (intoBuffer) {
+            copy(data, data + n, buffer);
+            local.move(n);
+        }
+        shared.add(local);
+        return;
+    }
+    
+    // Sort both halves into the opposite array, then merge them into the requested one
+    int mid = n / 2;
+    {
+        TaskGroup halves(pool);
+        halves.run([=, &pool, &shared] {
+            parallelMergeSortRange(data + mid, buffer + mid, n - mid, !intoBuffer, pool, shared);
+        });
+        parallelMergeSortRange(data, buffer, mid, !intoBuffer, pool, shared);
+        halves.wait();
+    }
+    
+    const int* src = intoBuffer ? data : buffer;
+    int* dst = intoBuffer ? buffer : data;
+    TaskGroup merges(pool);
+    parallelMerge(src, mid, src + mid, n - mid, dst, merges, shared);
+    merges.wait();
+}
+
+
+
+template <class Counter>
+void parallelQuickSortRange(int* data, int low, int high, int depthLimit,
+                            TaskGroup& group, SharedCounter<Counter>& shared) {  // Partition, fork the smaller side, loop on the larger
+    Counter local;
+    
+    while (high - low + 1 > PARALLEL_SORT_GRAIN) {
+        if (depthLimit == 0) {
+            heapSortRange(data, low, high, local);
+            shared.add(local);
+            return;
+        }
+        depthLimit--;
+        
+        choosePivot(data, low, high, local);
+        int pi = partition(data, low, high, local);
+        
+        int forkLow, forkHigh;
+        if (pi - low < high - pi) {
+            forkLow = low;
+            forkHigh = pi - 1;
+            low = pi + 1;
+        } else {
+            forkLow = pi + 1;
+            forkHigh = high;
+            high = pi - 1;
+        }
+        group.run([=, &group, &shared] {
+            parallelQuickSortRange(data, forkLow, forkHigh, depthLimit, group, shared);
+        });
+    }
+    
+    if (low < high) {
+        introSortLoop(data, low, high, depthLimit, local);
+    }
+    shared.add(local);
+}
+
+
+
+template <class Counter>
+void networkMergeSort(int* data, int n, int* buffer, Counter& counter) {  // Network-sorted blocks of 64, then merge passes
+    for (int left = 0; left < n; left += SEGMENT_NETWORK_MAX) {
+        smallSortNetwork(data + left, min(SEGMENT_NETWORK_MAX, n - left), counter);
+    }
+    
+    int* src = data;
+    int* dst = buffer;
+    for (int width = SEGMENT_NETWORK_MAX; width < n; width *= 2) {
+        for (int left = 0; left < n; left += 2 * width) {
+            mergeRuns(src, dst, left, min(left + width, n), min(left + 2 * width, n), counter);
+        }
+        swap(src, dst);
+    }
+    if (src != data) {
+        copy(src, src + n, data);
+        counter.move(n);
+    }
+}
+
+template <class Counter>
+void sortSegment(int* data, int n, vector<int>& buffer, Counter& counter) {  // Pick the kernel by segment size
+    if (n <= SEGMENT_INSERTION_MAX) {
+        insertionSortRange(data, 0, n - 1, counter);
+    } else if (n <= SEGMENT_NETWORK_MAX) {
+        smallSortNetwork(data, n, counter);
+    } else {
+        if ((int)buffer.size() < n) {
+            buffer.resize(n);
+        }
+        if (n < SEGMENT_RADIX_MIN) {
+            networkMergeSort(data, n, buffer.data(), counter);
+        } else {
+            radixSortRange(data, buffer.data(), n, counter);
+        }
+    }
+}
+
+template <class Counter>
+void sortSegmentBatch(int* data, const int* offsets, int first, int last,
+                      SharedCounter<Counter>& shared) {  // Sort segments [first, last); one scratch buffer for the batch
+    Counter local;
+    vector<int> buffer;
+    for (int s = first; s < last; s++) {
+        int begin = offsets[s], end = offsets[s + 1];
+        if (end - begin > 1) {
+            sortSegment(data + begin, end - begin, buffer, local);
+        }
+    }
+    shared.add(local);
+}
+
+
+
+template <class Counter>
+void parallelMergeSortEngine(int* data, int n, int threadCount, Counter& counter) {  // Fork-join merge sort with one shared buffer
+    if (n <= 1) {
+        return;
+    }
+    ThreadPool& pool = getSortThreadPool(threadCount);
+    SharedCounter<Counter> shared;
+    vector<int> buffer(n);
+    parallelMergeSortRange(data, buffer.data(), n, false, pool, shared);
+    counter.add(shared.total);
+}
+
+template <class Counter>
+void parallelQuickSortEngine(int* data, int n, int threadCount, Counter& counter) {  // Fork-join introsort
+    if (n <= 1) {
+        return;
+    }
+    ThreadPool& pool = getSortThreadPool(threadCount);
+    SharedCounter<Counter> shared;
+    TaskGroup group(pool);
+    parallelQuickSortRange(data, 0, n - 1, introSortDepthLimit(n), group, shared);
+    group.wait();
+    counter.add(shared.total);
+}
+
+template <class Counter>
+void segmentedSortEngine(int* data, const int* offsets, int segments, int threadCount, Counter& counter) {  // Batch segments into tasks
+    SharedCounter<Counter> shared;
+    int total = segments > 0 ? offsets[segments] - offsets[0] : 0;
+    
+    // Small jobs or one thread: no pool round trip
+    if (threadCount == 1 || total <= SEGMENT_TASK_GRAIN) {
+        sortSegmentBatch(data, offsets, 0, segments, shared);
+        counter.add(shared.total);
+        return;
+    }
+    
+    ThreadPool& pool = getSortThreadPool(threadCount);
+    TaskGroup group(pool);
+    int first = 0;
+    while (first < segments) {
+        int last = first;
+        while (last < segments && offsets[last + 1] - offsets[first] < SEGMENT_TASK_GRAIN) {
+            last++;
+        }
+        if (last == first) {
+            last++;  // One segment larger than the grain gets a task of its own
+        }
+        group.run([=, &shared] {
+            sortSegmentBatch(data, offsets, first, last, shared);
+        });
+        first = last;
+    }
+    group.wait();
+    counter.add(shared.total);
+}
+
+static long long sortCpuNs(ThreadPool& pool) {  // The calling thread's CPU time plus the pool workers': what a sort on pool used
+    timespec used;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &used);
+    return used.tv_sec * 1000000000LL + used.tv_nsec + pool.workerCpuNs();
+}
+
+template void parallelMergeSortEngine<NoCounter>(int*, int, int, NoCounter&);
+template void parallelMergeSortEngine<OperationCounter>(int*, int, int, OperationCounter&);
+template void parallelQuickSortEngine<NoCounter>(int*, int, int, NoCounter&);
+template void parallelQuickSortEngine<OperationCounter>(int*, int, int, OperationCounter&);
+template void segmentedSortEngine<NoCounter>(int*, const int*, int, int, NoCounter&);
+template void segmentedSortEngine<OperationCounter>(int*, const int*, int, int, OperationCounter&);
+
+
+
+SortResult parallelMergeSort(vector<int>& arr, int threadCount) {  // Parallel merge sort driver function
+    auto start = high_resolution_clock::now();
+    ThreadPool& pool = getSortThreadPool(threadCount);
+    long long cpuStart = sortCpuNs(pool);
+    OperationCounter counter;
+    
+    parallelMergeSortEngine(arr.data(), arr.size(), threadCount, counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    double cpuTimeMs = (sortCpuNs(pool) - cpuStart) / 1e6;
+    
+    return SortResult("Parallel Merge Sort", counter.comparisons, timeMs, cpuTimeMs, counter.moves);
+}
+
+
+
+SortResult parallelQuickSort(vector<int>& arr, int threadCount) {  // Parallel quicksort driver function
+    auto start = high_resolution_clock::now();
+    ThreadPool& pool = getSortThreadPool(threadCount);
+    long long cpuStart = sortCpuNs(pool);
+    OperationCounter counter;
+    
+    parallelQuickSortEngine(arr.data(), arr.size(), threadCount, counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    double cpuTimeMs = (sortCpuNs(pool) - cpuStart) / 1e6;
+    
+    return SortResult("Parallel Quick Sort", counter.comparisons, timeMs, cpuTimeMs, counter.moves);
+}
+
+
+
+bool segmentedSort(vector<int>& values, const vector<int>& offsets, SortResult& result, string& error,
+                   int threadCount) {  // Segmented sort driver function
+    // offsets must be non-decreasing and stay inside values; anything else is rejected unsorted
+    if (offsets.empty()) {
+        error = "segmentedSort: offsets is empty";
+        return false;
+    }
+    if (offsets.front() < 0 || offsets.back() > (int)values.size()) {
+        error = "segmentedSort: offsets outside [0, " + to_string(values.size()) + "]";
+        return false;
+    }
+    for (size_t i = 1; i < offsets.size(); i++) {
+        if (offsets[i - 1] > offsets[i]) {
+            error = "segmentedSort: offsets decrease at index " + to_string(i);
+            return false;
+        }
+    }
+    
+    auto start = high_resolution_clock::now();
+    ThreadPool& pool = getSortThreadPool(threadCount);
+    long long cpuStart = sortCpuNs(pool);
+    OperationCounter counter;
+    
+    segmentedSortEngine(values.data(), offsets.data(), offsets.size() - 1, threadCount, counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    double cpuTimeMs = (sortCpuNs(pool) - cpuStart) / 1e6;
+    
+    result = SortResult("Segmented Sort", counter.comparisons, timeMs, cpuTimeMs, counter.moves);
+    return true;
+}
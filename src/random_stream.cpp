@@ -0,0 +1,72 @@
+#include "../include/random_stream.h"
+#include "../include/simd_kernels.h"
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+
+
+const int RANDOM_FILL_LANES = 4;  // Interleaved streams per block, one per 64-bit AVX2 lane
+
+
+
+uint64_t freshSeed() {  // Hardware entropy once per process, then a counter through splitmix64
+    static const uint64_t base = ((uint64_t)random_device()() << 32) ^ random_device()();
+    static atomic<uint64_t> calls(0);
+    uint64_t x = base + calls.fetch_add(1) * 0xD1B54A32D192ED03ull;
+    return Xoshiro256::splitMix64(x);
+}
+
+
+
+static void fillBlock(int* out, int n, int low, uint64_t range, Xoshiro256 blockStream) {  // Lane l is the block stream long-jumped l times
+    uint64_t lanes[4][RANDOM_FILL_LANES];
+    for (int lane = 0; lane < RANDOM_FILL_LANES; lane++) {
+        for (int word = 0; word < 4; word++) {
+            lanes[word][lane] = blockStream.state[word];
+        }
+        blockStream.longJump();
+    }
+    simdFillUniform(out, n, low, range, lanes);
+}
+
+void fillUniform(int* out, int n, int low, int high, uint64_t seed, int threadCount) {  // Block b draws from the root stream jumped b times
+    if (n <= 0 || high < low) {
+        return;
+    }
+    uint64_t range = (uint64_t)((long long)high - low) + 1;
+    int blocks = (n + RANDOM_FILL_BLOCK - 1) / RANDOM_FILL_BLOCK;
+    
+    // Jumps are sequential but cheap (about a microsecond each), so every block start is computed up front
+    vector<Xoshiro256> starts;
+    starts.reserve(blocks);
+    Xoshiro256 root(seed);
+    for (int b = 0; b < blocks; b++) {
+        starts.push_back(root);
+        root.jump();
+    }
+    
+    if (blocks == 1 || threadCount == 1) {
+        for (int b = 0; b < blocks; b++) {
+            int first = b * RANDOM_FILL_BLOCK;
+            fillBlock(out + first, min(RANDOM_FILL_BLOCK, n - first), low, range, starts[b]);
+        }
+        return;
+    }
+    
+    ThreadPool& pool = getSortThreadPool(threadCount);
+    TaskGroup group(pool);
+    for (int b = 0; b < blocks; b++) {
+        int first = b * RANDOM_FILL_BLOCK;
+        int count = min(RANDOM_FILL_BLOCK, n - first);
+        const Xoshiro256& start = starts[b];
+        group.run([=, &start] {
+            fillBlock(out + first, count, low, range, start);
+        });
+    }
+    group.wait();
+}
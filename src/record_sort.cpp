@@ -0,0 +1,91 @@
+#include "../include/record_sort.h"
+#include "../include/corpus.h"
+#include "../include/dataset.h"
+#include "../include/keyed_sort.h"
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+using namespace chrono;
+
+
+
+template <class Record>
+SortResult sortRecords(vector<Record>& records, const string& label, bool stable) {  // Dispatch a label to its record kernel
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    Record* data = records.data();
+    int n = records.size();
+    string name;
+    
+    if (label == "Radix" || label == "Counting") {
+        name = "Key/Value Radix Sort";
+        if (n > 1) keyedRadixSort(data, n, RecordKey<Record>(), counter);
+    } else if (label == "Insertion" || label == "Bubble") {
+        name = "Key/Value Insertion Sort";
+        keyedInsertionSort(data, 0, n - 1, RecordKey<Record>(), counter);
+    } else if (stable || label == "Merge" || label == "Tim" || label == "ParallelMerge") {
+        name = "Key/Value Merge Sort";
+        keyedMergeSort(data, n, RecordKey<Record>(), counter);
+    } else {
+        name = "Key/Value Quick Sort";
+        if (n > 1) keyedIntroSortLoop(data, 0, n - 1, introSortDepthLimit(n), RecordKey<Record>(), counter);
+    }
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    
+    return SortResult(name, counter.comparisons, timeMs, -1.0, counter.moves);
+}
+
+template <class Record>
+SortResult sortRecords(vector<Record>& records, KNNPredictor& predictor, bool stable) {  // Predict from the keys alone, then sort
+    // One copy of the keys (4 bytes per record) feeds the capture hook and the same feature paths as int arrays;
+    // payloads do not affect the choice
+    vector<int> keys(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        keys[i] = records[i].key;
+    }
+    if (sortCaptureActive()) {
+        captureSortInput(keys.data(), keys.size(), "sortKeyValues");
+    }
+    Features features = keys.size() >= (size_t)SAMPLED_FEATURE_MIN_SIZE ? sampleFeatures(keys.data(), keys.size())
+                                                                        : extractFeatures(keys);
+    return sortRecords(records, predictor.predict(features), stable);
+}
+
+
+
+SortResult sortKeyValues(vector<KeyValue32>& records, const string& label, bool stable) {  // Sort 32-bit payload records
+    return sortRecords(records, label, stable);
+}
+
+SortResult sortKeyValues(vector<KeyValue64>& records, const string& label, bool stable) {  // Sort 64-bit payload records
+    return sortRecords(records, label, stable);
+}
+
+SortResult sortKeyValues(vector<KeyValue32>& records, KNNPredictor& predictor, bool stable) {  // Predict from keys, then sort
+    return sortRecords(records, predictor, stable);
+}
+
+SortResult sortKeyValues(vector<KeyValue64>& records, KNNPredictor& predictor, bool stable) {  // Predict from keys, then sort
+    return sortRecords(records, predictor, stable);
+}
+
+
+
+SortResult argsort(const vector<int>& keys, vector<int>& order, KNNPredictor& predictor, bool stable) {  // Sort (key, index) records, keep the indices
+    vector<KeyValue32> records(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        records[i].key = keys[i];
+        records[i].value = i;
+    }
+    
+    SortResult result = sortKeyValues(records, predictor, stable);
+    
+    order.resize(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        order[i] = records[i].value;
+    }
+    return result;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include "../include/dataset.h"
+#include "../include/knn_predictor.h"
+#include "../include/sorting_algorithms.h"
+#include "../include/mapped_sort.h"
+#include "../include/record_sort.h"
+#include "../include/timing_harness.h"
+
+using namespace std;
+
+
+
+// Regression checks for bugs that once shipped; each returns true when the old failure is gone
+
+static bool writeKeys(const string& file, const vector<int>& keys) {  // Raw native-endian int32 file
+    ofstream out(file.c_str(), ios::binary | ios::trunc);
+    out.write((const char*)keys.data(), keys.size() * sizeof(int));
+    return out.good();
+}
+
+static vector<int> readKeys(const string& file) {  // Whole raw int32 file
+    ifstream in(file.c_str(), ios::binary | ios::ate);
+    vector<int> keys(in.tellg() / (streamoff)sizeof(int));
+    in.seekg(0);
+    in.read((char*)keys.data(), keys.size() * sizeof(int));
+    return keys;
+}
+
+bool testMappedOutputIsInput() {  // The output path names the input: it used to be truncated to zeros before the mapping
+    vector<int> keys = generateRandom(300000, 7);
+    vector<int> expected = keys;
+    sort(expected.begin(), expected.end());
+    
+    KNNPredictor predictor(5);
+    predictor.loadDefaultTrainingData();
+    string file = "/tmp/regression_mapped_same.bin";
+    bool ok = true;
+    // The same path, and the same file under a second name
+    const string outputs[] = {file, "/tmp/../tmp/regression_mapped_same.bin"};
+    for (const string& output : outputs) {
+        MappedSortStats stats;
+        ok = ok && writeKeys(file, keys) && mappedSort(file, output, MAPPED_TO_OUTPUT, predictor, stats)
+                && readKeys(file) == expected;
+    }
+    remove(file.c_str());
+    return ok;
+}
+
+bool testExactUniqueStrideKeys() {  // Multiples of 2^16 used to share one probe cluster: about a second, now sub-millisecond
+    bool ok = true;
+    for (int shift = 8; shift <= 16; shift += 4) {
+        vector<int> keys(1 << 16);
+        for (int i = 0; i < (int)keys.size(); i++) {
+            keys[i] = (int)((unsigned)i << shift);
+        }
+        long long start = monotonicNs();
+        double ratio = exactUniqueRatio(keys.data(), keys.size());
+        double elapsedMs = (monotonicNs() - start) / 1e6;
+        // Sequential keys take well under a millisecond; clustering costs two orders of magnitude more
+        ok = ok && ratio == 1.0 && elapsedMs < 100;
+    }
+    return ok;
+}
+
+bool testCountingShiftedKeys() {  // 1000 distinct keys shifted left 16 bits used to cluster in the histogram table
+    Xoshiro256 gen(16);
+    vector<int> keys(1 << 20);
+    for (int& key : keys) {
+        key = (int)(gen.bounded(1000) << 16);
+    }
+    vector<int> expected = keys;
+    sort(expected.begin(), expected.end());
+    
+    long long start = monotonicNs();
+    findSortAlgorithm("Counting")->kernel(keys.data(), keys.size());
+    double elapsedMs = (monotonicNs() - start) / 1e6;
+    // A few milliseconds when the keys spread over the table; clustered, about half a second
+    return keys == expected && elapsedMs < 100;
+}
+
+bool testStableRecordsAndArgsort() {  // The record API, which no documented build linked: stable order of equal keys
+    Xoshiro256 gen(11);
+    vector<KeyValue64> records(200000);
+    vector<int> keys(records.size());
+    for (int i = 0; i < (int)records.size(); i++) {
+        records[i].key = keys[i] = gen.bounded(5000);
+        records[i].value = i;
+    }
+    
+    KNNPredictor predictor(5);
+    predictor.loadDefaultTrainingData();
+    vector<int> order;
+    sortKeyValues(records, predictor, true);
+    argsort(keys, order, predictor, true);
+    
+    bool ok = order.size() == records.size();
+    for (int i = 0; ok && i < (int)records.size(); i++) {
+        ok = (int)records[i].value == order[i]
+             && (i == 0 || records[i - 1].key < records[i].key
+                 || (records[i - 1].key == records[i].key && records[i - 1].value < records[i].value));
+    }
+    return ok;
+}
+
+
+
+int main() {  // Run every check; the exit status is the number that failed
+    struct Check {
+        const char* name;
+        bool (*run)();
+    };
+    const Check checks[] = {
+        {"mappedSort with output == input", testMappedOutputIsInput},
+        {"exactUniqueRatio on stride-aligned keys", testExactUniqueStrideKeys},
+        {"Counting sort on keys with 16 low zero bits", testCountingShiftedKeys},
+        {"Stable record sort and argsort", testStableRecordsAndArgsort},
+    };
+    
+    int failed = 0;
+    for (const Check& check : checks) {
+        bool passed = check.run();
+        cout << (passed ? "[PASS] " : "[FAIL] ") << check.name << endl;
+        failed += passed ? 0 : 1;
+    }
+    cout << (failed == 0 ? "All regression checks passed." : "Some regression checks failed.") << endl;
+    return failed;
+}
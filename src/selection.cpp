@@ -0,0 +1,288 @@
+#include "../include/sorting_algorithms.h"
+#include "../include/simd_kernels.h"
+#include <chrono>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+using namespace std;
+using namespace chrono;
+
+
+
+const int SELECT_INSERTION_CUTOFF = 16;     // Ranges up to this size are finished with insertion sort
+const int TOPK_HEAP_RATIO = 64;             // Bounded heap when k <= n / ratio, select-then-sort otherwise
+const int SELECT_FILTER_MIN_SIZE = 1 << 16; // Threshold filter only pays off on large arrays
+const int SELECT_FILTER_MAX_TAIL = 8;       // ... and when the wanted rank is within n / 8 of either end
+const int SELECT_SAMPLE_SIZE = 4096;        // Keys sampled to place the filter threshold
+
+
+
+template <class Counter>
+int medianOfMedians(int* data, int low, int high, Counter& counter);
+
+template <class Counter>
+void introSelectLoop(int* data, int low, int high, int k, int depthLimit, Counter& counter) {  // Quickselect with a median-of-medians fallback
+    while (high - low + 1 > SELECT_INSERTION_CUTOFF) {
+        // Out of budget: median-of-medians pivots from here on guarantee O(n)
+        if (depthLimit == 0) {
+            int pivotIndex = medianOfMedians(data, low, high, counter);
+            swap(data[pivotIndex], data[high]);
+            counter.move(2);
+        } else {
+            depthLimit--;
+            choosePivot(data, low, high, counter);
+        }
+        int pivot = data[high];
+        
+        // Three-way partition, so runs of equal keys end the search instead of stalling it
+        int lt = low, i = low, gt = high;
+        while (i <= gt) {
+            counter.compare();
+            if (data[i] < pivot) {
+                swap(data[lt++], data[i++]);
+                counter.move(2);
+            } else {
+                counter.compare();
+                if (pivot < data[i]) {
+                    swap(data[i], data[gt--]);
+                    counter.move(2);
+                } else {
+                    i++;
+                }
+            }
+        }
+        
+        // Keep only the side holding rank k
+        if (k < lt) {
+            high = lt - 1;
+        } else if (k > gt) {
+            low = gt + 1;
+        } else {
+            return;
+        }
+    }
+    
+    if (low < high) {
+        insertionSortRange(data, low, high, counter);
+    }
+}
+
+template <class Counter>
+int medianOfMedians(int* data, int low, int high, Counter& counter) {  // BFPRT pivot: median of the medians of groups of five
+    int groups = 0;
+    for (int left = low; left <= high; left += 5) {
+        int right = min(left + 4, high);
+        insertionSortRange(data, left, right, counter);
+        
+        // Gather the group medians at the front of the range
+        swap(data[low + groups], data[left + (right - left) / 2]);
+        counter.move(2);
+        groups++;
+    }
+    
+    int mid = low + groups / 2;
+    introSelectLoop(data, low, low + groups - 1, mid, 0, counter);
+    return mid;
+}
+
+
+
+template <class Counter>
+void topKSiftDown(int* heap, int root, int size, Counter& counter) {  // Max-heap sift for the bounded heap
+    while (true) {
+        int child = 2 * root + 1;
+        if (child >= size) break;
+        if (child + 1 < size) {
+            counter.compare();
+            if (heap[child] < heap[child + 1]) child++;
+        }
+        counter.compare();
+        if (!(heap[root] < heap[child])) break;
+        swap(heap[root], heap[child]);
+        counter.move(2);
+        root = child;
+    }
+}
+
+template <class Counter>
+void heapTopK(int* data, int n, int k, Counter& counter) {  // Keep the k smallest in a max-heap at data[0, k)
+    for (int root = k / 2 - 1; root >= 0; root--) {
+        topKSiftDown(data, root, k, counter);
+    }
+    
+    // Most keys lose to the heap top; the vectorized scan skips them eight at a time
+    int i = k;
+    while (i < n) {
+        int next = i + simdFirstBelow(data + i, n - i, data[0]);
+        counter.compare(next - i + (next < n ? 1 : 0));
+        if (next == n) break;
+        
+        swap(data[0], data[next]);
+        counter.move(2);
+        topKSiftDown(data, 0, k, counter);
+        i = next + 1;
+    }
+    
+    heapSortRange(data, 0, k - 1, counter);
+}
+
+
+
+template <class Counter>
+bool filterSelect(const int* data, int n, int k, int& value, Counter& counter) {  // k-th smallest from a threshold-filtered candidate set
+    int tailRank = min(k, n - 1 - k);
+    if (n < SELECT_FILTER_MIN_SIZE || tailRank > n / SELECT_FILTER_MAX_TAIL) {
+        return false;
+    }
+    bool lowerTail = k <= n - 1 - k;
+    
+    // Place the threshold a few standard deviations past the wanted rank in a sorted sample
+    vector<int> sample(SELECT_SAMPLE_SIZE);
+    int stride = n / SELECT_SAMPLE_SIZE;
+    for (int i = 0; i < SELECT_SAMPLE_SIZE; i++) {
+        sample[i] = data[i * stride];
+    }
+    introSortLoop(sample.data(), 0, SELECT_SAMPLE_SIZE - 1, introSortDepthLimit(SELECT_SAMPLE_SIZE), counter);
+    double expected = (tailRank + 1.0) * SELECT_SAMPLE_SIZE / n;
+    int position = (int)(expected + 3.0 * sqrt(expected) + 16);
+    if (position >= SELECT_SAMPLE_SIZE) {
+        return false;
+    }
+    int threshold = lowerTail ? sample[position] : sample[SELECT_SAMPLE_SIZE - 1 - position];
+    
+    // One streaming pass keeps only the keys on the wanted side of the threshold
+    // Room for twice the expected share; overflowing means a skewed sample and we fall back
+    int capacity = (int)min((long long)n, (long long)n * 2 * (position + 1) / SELECT_SAMPLE_SIZE + 64);
+    vector<int> candidates(capacity + 8);
+    int count = lowerTail ? simdCollectRange(data, n, INT_MIN, threshold, candidates.data(), capacity)
+                          : simdCollectRange(data, n, threshold, INT_MAX, candidates.data(), capacity);
+    counter.compare(n);
+    counter.move(max(count, 0));
+    if (count < tailRank + 1) {
+        return false;  // Threshold landed on the wrong side of rank k (or too many ties); fall back
+    }
+    
+    // Every key ranked before k on that side is a candidate, so k keeps its rank among them
+    int rank = lowerTail ? k : count - (n - k);
+    introSelectLoop(candidates.data(), 0, count - 1, rank, introSortDepthLimit(count), counter);
+    value = candidates[rank];
+    return true;
+}
+
+
+
+template <class Counter>
+int selectValueEngine(const int* data, int n, int k, Counter& counter) {  // Read-only k-th smallest
+    int value;
+    if (filterSelect(data, n, k, value, counter)) {
+        return value;
+    }
+    
+    vector<int> copyOfData(data, data + n);
+    counter.move(n);
+    introSelectLoop(copyOfData.data(), 0, n - 1, k, introSortDepthLimit(n), counter);
+    return copyOfData[k];
+}
+
+template <class Counter>
+void nthElementEngine(int* data, int n, int k, Counter& counter) {  // In-place selection, nth_element semantics
+    if (k < 0 || k >= n) {
+        return;
+    }
+    
+    // Large array, rank near an end: find the value with the filter, then one partition pass places it
+    int value;
+    if (filterSelect(data, n, k, value, counter)) {
+        int lt = 0, i = 0, gt = n - 1;
+        while (i <= gt) {
+            counter.compare();
+            if (data[i] < value) {
+                swap(data[lt++], data[i++]);
+                counter.move(2);
+            } else {
+                counter.compare();
+                if (value < data[i]) {
+                    swap(data[i], data[gt--]);
+                    counter.move(2);
+                } else {
+                    i++;
+                }
+            }
+        }
+        return;
+    }
+    
+    introSelectLoop(data, 0, n - 1, k, introSortDepthLimit(n), counter);
+}
+
+template <class Counter>
+void partialSortEngine(int* data, int n, int k, Counter& counter) {  // Smallest k keys, sorted, at the front
+    if (k <= 0 || n <= 1) {
+        return;
+    }
+    if (k >= n) {
+        introSortLoop(data, 0, n - 1, introSortDepthLimit(n), counter);
+        return;
+    }
+    
+    if ((long long)k * TOPK_HEAP_RATIO <= n) {
+        heapTopK(data, n, k, counter);
+        return;
+    }
+    
+    nthElementEngine(data, n, k - 1, counter);
+    introSortLoop(data, 0, k - 1, introSortDepthLimit(k), counter);
+}
+
+template void nthElementEngine<NoCounter>(int*, int, int, NoCounter&);
+template void nthElementEngine<OperationCounter>(int*, int, int, OperationCounter&);
+template void partialSortEngine<NoCounter>(int*, int, int, NoCounter&);
+template void partialSortEngine<OperationCounter>(int*, int, int, OperationCounter&);
+template int selectValueEngine<NoCounter>(const int*, int, int, NoCounter&);
+template int selectValueEngine<OperationCounter>(const int*, int, int, OperationCounter&);
+
+
+
+SortResult nthElement(vector<int>& arr, int k) {  // Selection driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    
+    nthElementEngine(arr.data(), arr.size(), k, counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    
+    return SortResult("Nth Element", counter.comparisons, timeMs, -1.0, counter.moves);
+}
+
+SortResult partialSortTopK(vector<int>& arr, int k) {  // Top-k driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    
+    partialSortEngine(arr.data(), arr.size(), k, counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    
+    return SortResult("Partial Sort (Top-k)", counter.comparisons, timeMs, -1.0, counter.moves);
+}
+
+SortResult percentile(const vector<int>& arr, double p, int& value) {  // Percentile driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    
+    int n = arr.size();
+    value = 0;
+    if (n > 0) {
+        // Nearest rank: the smallest key with at least p% of the keys at or below it
+        int k = (int)ceil(p / 100.0 * n) - 1;
+        k = max(0, min(n - 1, k));
+        value = selectValueEngine(arr.data(), n, k, counter);
+    }
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    
+    return SortResult("Percentile", counter.comparisons, timeMs, -1.0, counter.moves);
+}
@@ -0,0 +1,702 @@
+#include "../include/sorting_algorithms.h"
+#include "../include/simd_kernels.h"
+#include <chrono>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_SORT_X86 1
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+using namespace std;
+using namespace chrono;
+
+
+
+const int SIMD_LEAF_SIZE = 64;  // Partitions up to this size go to the sorting-network kernel
+
+
+
+static inline unsigned hashKey32(int key) {  // Bijective 32-bit mix: distinct keys never collide
+    unsigned h = (unsigned)key;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+
+
+static inline bool hashSeen(unsigned h, const unsigned* seen, unsigned seenMask) {  // h already sits in its home slot
+    return seen != nullptr && seen[h & seenMask] == h && h != 0xFFFFFFFFu;
+}
+
+static int scanBlockScalar(const int* data, int n, int pairs, unsigned limit, unsigned* out, ScanState& state,
+                           const unsigned* seen, unsigned seenMask) {  // Reference scan, also the vector tail
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        state.minValue = min(state.minValue, data[i]);
+        state.maxValue = max(state.maxValue, data[i]);
+        unsigned h = hashKey32(data[i]);
+        if (h <= limit && !hashSeen(h, seen, seenMask)) out[count++] = h;
+        
+        if (i >= pairs) continue;
+        // Equal neighbours continue the current run in either direction; before any strict pair they have none
+        int descending = data[i] > data[i + 1] ? 1 : data[i] < data[i + 1] ? 0 : state.lastDescending;
+        if (data[i] <= data[i + 1]) state.ascendingPairs++;
+        if (data[i] >= data[i + 1]) state.descendingPairs++;
+        if (descending < 0) {
+            state.leadingEqual++;
+        } else if (state.firstDescending < 0) {
+            state.firstDescending = descending;
+        }
+        if (state.lastDescending >= 0 && descending != state.lastDescending) {
+            if (state.turns == 0) {
+                state.firstRun = state.currentRun;
+            } else {
+                state.longestRun = max(state.longestRun, state.currentRun);
+            }
+            state.turns++;
+            state.currentRun = 0;
+        }
+        state.currentRun++;
+        state.lastDescending = descending;
+    }
+    return count;
+}
+
+
+
+static inline uint64_t xoshiroLaneNext(uint64_t state[4][4], int lane) {  // xoshiro256** on one lane of the interleaved state
+    uint64_t s0 = state[0][lane], s1 = state[1][lane], s2 = state[2][lane], s3 = state[3][lane];
+    uint64_t x = s1 * 5;
+    uint64_t result = ((x << 7) | (x >> 57)) * 9;
+    uint64_t t = s1 << 17;
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= t;
+    s3 = (s3 << 45) | (s3 >> 19);
+    state[0][lane] = s0;
+    state[1][lane] = s1;
+    state[2][lane] = s2;
+    state[3][lane] = s3;
+    return result;
+}
+
+static void fillUniformScalar(int* out, int n, int low, uint64_t range, uint64_t state[4][4]) {  // Reference fill, also the vector tail
+    for (int i = 0; i < n; i += 8) {
+        unsigned keys[8];
+        for (int lane = 0; lane < 4; lane++) {
+            uint64_t bits = xoshiroLaneNext(state, lane);
+            keys[2 * lane] = (unsigned)bits;
+            keys[2 * lane + 1] = (unsigned)(bits >> 32);
+        }
+        for (int j = 0; j < 8 && i + j < n; j++) {
+            out[i + j] = (int)((unsigned)low + (unsigned)(((uint64_t)keys[j] * range) >> 32));
+        }
+    }
+}
+
+
+
+#ifdef SIMD_SORT_X86
+
+struct PartitionTable {  // For each 8-bit "less than pivot" mask: lane order that packs those lanes first
+    alignas(32) int perm[256][8];
+    
+    PartitionTable() {
+        for (int mask = 0; mask < 256; mask++) {
+            int k = 0;
+            for (int lane = 0; lane < 8; lane++) {
+                if (mask & (1 << lane)) perm[mask][k++] = lane;
+            }
+            for (int lane = 0; lane < 8; lane++) {
+                if (!(mask & (1 << lane))) perm[mask][k++] = lane;
+            }
+        }
+    }
+};
+
+static const PartitionTable& getPartitionTable() {  // Built once, on first use
+    static const PartitionTable table;
+    return table;
+}
+
+struct TurnGapTable {  // For each 8-bit turn mask: the longest run between two of its turns, in pairs
+    unsigned char gap[256];
+    
+    TurnGapTable() {
+        for (int mask = 0; mask < 256; mask++) {
+            gap[mask] = 0;
+            int previous = -1;
+            for (int lane = 0; lane < 8; lane++) {
+                if (!(mask & (1 << lane))) continue;
+                if (previous >= 0) gap[mask] = max((int)gap[mask], lane - previous);
+                previous = lane;
+            }
+        }
+    }
+};
+
+static const TurnGapTable& getTurnGapTable() {  // Built once, on first use
+    static const TurnGapTable table;
+    return table;
+}
+
+bool cpuHasAvx2() {  // Runtime CPUID check, cached
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+
+
+AVX2_TARGET static inline void partitionVector(__m256i v, __m256i pivotVec, int* base, int& writeLeft, int& writeRight,
+                                               const PartitionTable& table) {  // Compress-store 8 keys to both ends
+    // Lanes with v < pivot, packed to the front of the vector; the rest follow
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivotVec, v)));
+    __m256i perm = _mm256_load_si256((const __m256i*)table.perm[mask]);
+    __m256i packed = _mm256_permutevar8x32_epi32(v, perm);
+    int lessCount = __builtin_popcount(mask);
+    
+    // Store the whole vector at both write cursors and advance each by its share
+    _mm256_storeu_si256((__m256i*)(base + writeLeft), packed);
+    writeLeft += lessCount;
+    _mm256_storeu_si256((__m256i*)(base + writeRight - 8), packed);
+    writeRight -= 8 - lessCount;
+}
+
+template <class Counter>
+AVX2_TARGET int avx2Partition(int* data, int low, int high, Counter& counter) {  // In-place vectorized partition around data[high]
+    int pivot = data[high];
+    int* base = data + low;
+    int n = high - low;  // Elements to partition, pivot excluded (n >= 16)
+    
+    const PartitionTable& table = getPartitionTable();
+    __m256i pivotVec = _mm256_set1_epi32(pivot);
+    
+    // Save one vector from each end; that frees 16 slots for the full-width stores below
+    __m256i first = _mm256_loadu_si256((const __m256i*)base);
+    __m256i last = _mm256_loadu_si256((const __m256i*)(base + n - 8));
+    int readLeft = 8, readRight = n - 8;
+    int writeLeft = 0, writeRight = n;
+    
+    // Always read from the side with less free room, so neither store can overrun unread data
+    while (readRight - readLeft >= 8) {
+        __m256i v;
+        if (readLeft - writeLeft <= writeRight - readRight) {
+            v = _mm256_loadu_si256((const __m256i*)(base + readLeft));
+            readLeft += 8;
+        } else {
+            readRight -= 8;
+            v = _mm256_loadu_si256((const __m256i*)(base + readRight));
+        }
+        partitionVector(v, pivotVec, base, writeLeft, writeRight, table);
+    }
+    
+    // Fewer than 8 unread keys remain: copy them out, then place them one by one
+    int tail[8];
+    int tailCount = readRight - readLeft;
+    memcpy(tail, base + readLeft, tailCount * sizeof(int));
+    for (int i = 0; i < tailCount; i++) {
+        if (tail[i] < pivot) base[writeLeft++] = tail[i];
+        else base[--writeRight] = tail[i];
+    }
+    
+    partitionVector(first, pivotVec, base, writeLeft, writeRight, table);
+    partitionVector(last, pivotVec, base, writeLeft, writeRight, table);
+    counter.compare(n);
+    counter.move(n);
+    
+    int mid = low + writeLeft;
+    swap(data[mid], data[high]);
+    counter.move(2);
+    return mid;
+}
+
+
+
+AVX2_TARGET static inline void compareExchange(__m256i& a, __m256i& b) {  // Lane-wise a = min, b = max
+    __m256i low = _mm256_min_epi32(a, b);
+    b = _mm256_max_epi32(a, b);
+    a = low;
+}
+
+AVX2_TARGET static inline __m256i sortBitonicVector(__m256i v) {  // Sort a bitonic 8-lane vector ascending
+    __m256i p = _mm256_permute2x128_si256(v, v, 0x01);
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xF0);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xCC);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xAA);
+    return v;
+}
+
+AVX2_TARGET static void mergeSortedVectors(__m256i* v, int count) {  // Merge sorted v[0, count/2) and v[count/2, count)
+    // Reversing the second run turns the pair into one bitonic sequence
+    __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    int half = count / 2;
+    for (int i = 0; i < half / 2; i++) {
+        swap(v[half + i], v[count - 1 - i]);
+    }
+    for (int i = half; i < count; i++) {
+        v[i] = _mm256_permutevar8x32_epi32(v[i], reverse);
+    }
+    
+    // Bitonic half-cleaners across registers, then inside each register
+    for (int distance = half; distance >= 1; distance /= 2) {
+        for (int i = 0; i < count; i++) {
+            if ((i & distance) == 0) compareExchange(v[i], v[i + distance]);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        v[i] = sortBitonicVector(v[i]);
+    }
+}
+
+AVX2_TARGET static void transpose8x8(__m256i* r) {  // Rows become columns
+    __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]), t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]), t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]), t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]), t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+    
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+    
+    r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+template <class Counter>
+AVX2_TARGET void avx2SortNetwork64(int* data, int n, Counter& counter) {  // Sort up to 64 keys in registers
+    // Pad to a full 8x8 block; INT_MAX padding sorts to the end and is dropped
+    alignas(32) int block[SIMD_LEAF_SIZE];
+    memcpy(block, data, n * sizeof(int));
+    for (int i = n; i < SIMD_LEAF_SIZE; i++) {
+        block[i] = INT_MAX;
+    }
+    
+    __m256i r[8];
+    for (int i = 0; i < 8; i++) {
+        r[i] = _mm256_load_si256((const __m256i*)(block + 8 * i));
+    }
+    
+    // Optimal 19-comparator network sorts all 8 columns at once
+    static const int network[19][2] = {
+        {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7},
+        {0, 1}, {2, 3}, {4, 5}, {6, 7}, {2, 4}, {3, 5}, {1, 4}, {3, 6},
+        {1, 2}, {3, 4}, {5, 6}
+    };
+    for (int c = 0; c < 19; c++) {
+        compareExchange(r[network[c][0]], r[network[c][1]]);
+    }
+    
+    // Sorted columns become sorted rows; merge rows pairwise into 16, 32, then 64
+    transpose8x8(r);
+    for (int width = 2; width <= 8; width *= 2) {
+        for (int i = 0; i < 8; i += width) {
+            mergeSortedVectors(r + i, width);
+        }
+    }
+    
+    for (int i = 0; i < 8; i++) {
+        _mm256_store_si256((__m256i*)(block + 8 * i), r[i]);
+    }
+    memcpy(data, block, n * sizeof(int));
+    
+    // Lane comparisons of the fixed network: 152 for the columns, 480 for the three merge levels
+    counter.compare(632);
+    counter.move(n);
+}
+
+
+
+template <class Counter>
+AVX2_TARGET void avx2IntroSortLoop(int* data, int low, int high, int depthLimit, Counter& counter) {  // Introsort with vectorized partition and leaves
+    while (high - low + 1 > SIMD_LEAF_SIZE) {
+        if (depthLimit == 0) {
+            heapSortRange(data, low, high, counter);
+            return;
+        }
+        depthLimit--;
+        
+        choosePivot(data, low, high, counter);
+        int pi = avx2Partition(data, low, high, counter);
+        
+        // Recurse into the smaller side, loop on the larger
+        if (pi - low < high - pi) {
+            avx2IntroSortLoop(data, low, pi - 1, depthLimit, counter);
+            low = pi + 1;
+        } else {
+            avx2IntroSortLoop(data, pi + 1, high, depthLimit, counter);
+            high = pi - 1;
+        }
+    }
+    
+    if (high > low) {
+        avx2SortNetwork64(data + low, high - low + 1, counter);
+    }
+}
+
+AVX2_TARGET static int avx2FirstBelow(const int* data, int n, int threshold) {  // Eight keys per compare; stop at the first lane below
+    __m256i limit = _mm256_set1_epi32(threshold);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(limit, v)));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    for (; i < n; i++) {
+        if (data[i] < threshold) return i;
+    }
+    return n;
+}
+
+AVX2_TARGET static int avx2CollectRange(const int* data, int n, int low, int high, int* out, int capacity) {  // Compress-store keys in [low, high]
+    const PartitionTable& table = getPartitionTable();
+    __m256i lowVec = _mm256_set1_epi32(low);
+    __m256i highVec = _mm256_set1_epi32(high);
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(lowVec, v), _mm256_cmpgt_epi32(v, highVec));
+        int keep = ~_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF;
+        if (keep) {
+            // Full-width store; only the first popcount(keep) lanes are kept, out has 8 slots of slack
+            __m256i perm = _mm256_load_si256((const __m256i*)table.perm[keep]);
+            _mm256_storeu_si256((__m256i*)(out + count), _mm256_permutevar8x32_epi32(v, perm));
+            count += __builtin_popcount(keep);
+            if (count > capacity) return -1;
+        }
+    }
+    for (; i < n; i++) {
+        if (data[i] >= low && data[i] <= high) {
+            if (count == capacity) return -1;
+            out[count++] = data[i];
+        }
+    }
+    return count;
+}
+
+AVX2_TARGET static inline int avx2DropSeen(__m256i h, int keep, const unsigned* seen, __m256i seenMaskVec) {  // Clear lanes already in their home slot
+    if (seen == nullptr) {
+        return keep;
+    }
+    // Low-cardinality input keeps the sketch unfilled and the limit open; one gather then saves a probe per key.
+    // The all-ones hash also marks a free slot, so it is never taken as seen.
+    __m256i held = _mm256_i32gather_epi32((const int*)seen, _mm256_and_si256(h, seenMaskVec), 4);
+    __m256i present = _mm256_andnot_si256(_mm256_cmpeq_epi32(h, _mm256_set1_epi32(-1)), _mm256_cmpeq_epi32(held, h));
+    return keep & ~_mm256_movemask_ps(_mm256_castsi256_ps(present));
+}
+
+AVX2_TARGET static int avx2HashAtMost(const int* data, int n, unsigned limit, unsigned* out,
+                                      const unsigned* seen, unsigned seenMask) {  // Hash eight keys at once, compress-store the small ones
+    const PartitionTable& table = getPartitionTable();
+    __m256i multiplier1 = _mm256_set1_epi32(0x7feb352d);
+    __m256i multiplier2 = _mm256_set1_epi32(0x846ca68b);
+    __m256i limitVec = _mm256_set1_epi32((int)limit);
+    __m256i seenMaskVec = _mm256_set1_epi32((int)seenMask);
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i h = _mm256_loadu_si256((const __m256i*)(data + i));
+        h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+        h = _mm256_mullo_epi32(h, multiplier1);
+        h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+        h = _mm256_mullo_epi32(h, multiplier2);
+        h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+        
+        // Unsigned h <= limit  <=>  min(h, limit) == h
+        __m256i atMost = _mm256_cmpeq_epi32(_mm256_min_epu32(h, limitVec), h);
+        int keep = _mm256_movemask_ps(_mm256_castsi256_ps(atMost));
+        if (keep) {
+            keep = avx2DropSeen(h, keep, seen, seenMaskVec);
+        }
+        if (keep) {
+            __m256i perm = _mm256_load_si256((const __m256i*)table.perm[keep]);
+            _mm256_storeu_si256((__m256i*)(out + count), _mm256_permutevar8x32_epi32(h, perm));
+            count += __builtin_popcount(keep);
+        }
+    }
+    for (; i < n; i++) {
+        unsigned h = hashKey32(data[i]);
+        if (h <= limit && !hashSeen(h, seen, seenMask)) out[count++] = h;
+    }
+    return count;
+}
+
+AVX2_TARGET static int avx2ScanBlock(const int* data, int n, int pairs, unsigned limit, unsigned* out, ScanState& state,
+                                     const unsigned* seen, unsigned seenMask) {  // Pair masks, min/max and hash filter per load
+    const PartitionTable& table = getPartitionTable();
+    const TurnGapTable& gaps = getTurnGapTable();
+    __m256i multiplier1 = _mm256_set1_epi32(0x7feb352d);
+    __m256i multiplier2 = _mm256_set1_epi32(0x846ca68b);
+    __m256i limitVec = _mm256_set1_epi32((int)limit);
+    __m256i seenMaskVec = _mm256_set1_epi32((int)seenMask);
+    __m256i minVec = _mm256_set1_epi32(state.minValue);
+    __m256i maxVec = _mm256_set1_epi32(state.maxValue);
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= pairs; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(data + i + 1));
+        minVec = _mm256_min_epi32(minVec, a);
+        maxVec = _mm256_max_epi32(maxVec, a);
+        
+        // Bit j: pair (i + j, i + j + 1) strictly descending / strictly ascending
+        int down = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b)));
+        int up = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(b, a)));
+        state.ascendingPairs += 8 - __builtin_popcount(down);
+        state.descendingPairs += 8 - __builtin_popcount(up);
+        
+        // Before any strict pair, equal lanes just extend the first run; the first strict lane then seeds the
+        // incoming direction, so the equal lanes ahead of it take its direction and no turn is counted there
+        int strict = down | up;
+        int incoming = state.lastDescending;
+        if (incoming < 0 && strict != 0) {
+            int lead = __builtin_ctz(strict);
+            state.leadingEqual += lead;
+            state.firstDescending = (down >> lead) & 1;
+            incoming = state.firstDescending;
+        } else if (incoming < 0) {
+            state.leadingEqual += 8;
+        }
+        
+        // Equal pairs take the direction of the pair before them: fill bit 0 (the incoming direction) and the
+        // strict bits forward across runs of equal lanes, doubling the distance each step
+        int direction = (down << 1) | (incoming > 0 ? 1 : 0);
+        int equal = (~strict & 0xFF) << 1;
+        direction |= (direction << 1) & equal;
+        equal &= equal << 1;
+        direction |= (direction << 2) & equal;
+        equal &= equal << 2;
+        direction |= (direction << 4) & equal;
+        equal &= equal << 4;
+        direction |= (direction << 8) & equal;
+        
+        // A turn is a pair whose direction differs from the one before it
+        int turnMask = ((direction >> 1) ^ direction) & 0xFF;
+        state.lastDescending = incoming < 0 ? -1 : (direction >> 8) & 1;
+        if (turnMask == 0) {
+            state.currentRun += 8;
+        } else {
+            int first = __builtin_ctz(turnMask);
+            int last = 31 - __builtin_clz(turnMask);
+            if (state.turns == 0) {
+                state.firstRun = state.currentRun + first;
+            } else {
+                state.longestRun = max(state.longestRun, state.currentRun + first);
+            }
+            state.turns += __builtin_popcount(turnMask);
+            state.longestRun = max(state.longestRun, (int)gaps.gap[turnMask]);  // Runs strictly inside these eight pairs
+            state.currentRun = 8 - last;
+        }
+        
+        __m256i h = a;
+        h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+        h = _mm256_mullo_epi32(h, multiplier1);
+        h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+        h = _mm256_mullo_epi32(h, multiplier2);
+        h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+        __m256i atMost = _mm256_cmpeq_epi32(_mm256_min_epu32(h, limitVec), h);
+        int keep = _mm256_movemask_ps(_mm256_castsi256_ps(atMost));
+        if (keep) {
+            keep = avx2DropSeen(h, keep, seen, seenMaskVec);
+        }
+        if (keep) {
+            __m256i perm = _mm256_load_si256((const __m256i*)table.perm[keep]);
+            _mm256_storeu_si256((__m256i*)(out + count), _mm256_permutevar8x32_epi32(h, perm));
+            count += __builtin_popcount(keep);
+        }
+    }
+    
+    alignas(32) int lanes[8];
+    _mm256_store_si256((__m256i*)lanes, minVec);
+    state.minValue = *min_element(lanes, lanes + 8);
+    _mm256_store_si256((__m256i*)lanes, maxVec);
+    state.maxValue = *max_element(lanes, lanes + 8);
+    
+    // GCC leaves the upper halves dirty before this tail call, which slows every later SSE instruction
+    _mm256_zeroupper();
+    return count + scanBlockScalar(data + i, n - i, pairs - i, limit, out + count, state, seen, seenMask);
+}
+
+AVX2_TARGET static void avx2FillUniform(int* out, int n, int low, uint64_t range, uint64_t state[4][4]) {  // Four xoshiro256** lanes per step, eight keys per store
+    __m256i s0 = _mm256_loadu_si256((const __m256i*)state[0]);
+    __m256i s1 = _mm256_loadu_si256((const __m256i*)state[1]);
+    __m256i s2 = _mm256_loadu_si256((const __m256i*)state[2]);
+    __m256i s3 = _mm256_loadu_si256((const __m256i*)state[3]);
+    __m256i rangeVec = _mm256_set1_epi64x((long long)range);
+    __m256i lowVec = _mm256_set1_epi32(low);
+    bool rawBits = range > 0xFFFFFFFFull;  // The full int range: the multiply-shift is the identity
+    
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // No 64-bit multiply in AVX2: x * 5 and x * 9 as shift-adds
+        __m256i x = _mm256_add_epi64(s1, _mm256_slli_epi64(s1, 2));
+        x = _mm256_or_si256(_mm256_slli_epi64(x, 7), _mm256_srli_epi64(x, 57));
+        __m256i bits = _mm256_add_epi64(x, _mm256_slli_epi64(x, 3));
+        
+        __m256i t = _mm256_slli_epi64(s1, 17);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+        
+        if (!rawBits) {  // High halves of the 32x32 products: even keys from one multiply, odd keys from another
+            __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(bits, rangeVec), 32);
+            __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(bits, 32), rangeVec);
+            bits = _mm256_blend_epi32(even, odd, 0xAA);
+        }
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_add_epi32(bits, lowVec));
+    }
+    
+    _mm256_storeu_si256((__m256i*)state[0], s0);
+    _mm256_storeu_si256((__m256i*)state[1], s1);
+    _mm256_storeu_si256((__m256i*)state[2], s2);
+    _mm256_storeu_si256((__m256i*)state[3], s3);
+    _mm256_zeroupper();
+    fillUniformScalar(out + i, n - i, low, range, state);
+}
+
+#else
+
+bool cpuHasAvx2() {  // Non-x86 build: always take the scalar path
+    return false;
+}
+
+#endif
+
+
+
+int simdFirstBelow(const int* data, int n, int threshold) {  // Scan for the first key below threshold
+#ifdef SIMD_SORT_X86
+    if (cpuHasAvx2()) {
+        return avx2FirstBelow(data, n, threshold);
+    }
+#endif
+    for (int i = 0; i < n; i++) {
+        if (data[i] < threshold) return i;
+    }
+    return n;
+}
+
+int simdCollectRange(const int* data, int n, int low, int high, int* out, int capacity) {  // Threshold filter into out
+#ifdef SIMD_SORT_X86
+    if (cpuHasAvx2()) {
+        return avx2CollectRange(data, n, low, high, out, capacity);
+    }
+#endif
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        if (data[i] >= low && data[i] <= high) {
+            if (count == capacity) return -1;
+            out[count++] = data[i];
+        }
+    }
+    return count;
+}
+
+
+int simdHashAtMost(const int* data, int n, unsigned limit, unsigned* out, const unsigned* seen, unsigned seenMask) {  // Hash filter into out
+#ifdef SIMD_SORT_X86
+    if (cpuHasAvx2()) {
+        return avx2HashAtMost(data, n, limit, out, seen, seenMask);
+    }
+#endif
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        unsigned h = hashKey32(data[i]);
+        if (h <= limit && !hashSeen(h, seen, seenMask)) out[count++] = h;
+    }
+    return count;
+}
+
+int simdScanBlock(const int* data, int n, int pairs, unsigned limit, unsigned* out, ScanState& state,
+                  const unsigned* seen, unsigned seenMask) {  // Fused feature scan of one block
+#ifdef SIMD_SORT_X86
+    if (cpuHasAvx2()) {
+        return avx2ScanBlock(data, n, pairs, limit, out, state, seen, seenMask);
+    }
+#endif
+    return scanBlockScalar(data, n, pairs, limit, out, state, seen, seenMask);
+}
+
+void simdFillUniform(int* out, int n, int low, uint64_t range, uint64_t state[4][4]) {  // Bulk uniform keys from interleaved streams
+#ifdef SIMD_SORT_X86
+    if (cpuHasAvx2()) {
+        avx2FillUniform(out, n, low, range, state);
+        return;
+    }
+#endif
+    fillUniformScalar(out, n, low, range, state);
+}
+
+
+
+template <class Counter>
+void smallSortNetwork(int* data, int n, Counter& counter) {  // In-register network for n <= 64; insertion sort without AVX2
+    if (n <= 1) {
+        return;
+    }
+#ifdef SIMD_SORT_X86
+    if (n <= SIMD_LEAF_SIZE && cpuHasAvx2()) {
+        avx2SortNetwork64(data, n, counter);
+        return;
+    }
+#endif
+    insertionSortRange(data, 0, n - 1, counter);
+}
+
+template void smallSortNetwork<NoCounter>(int*, int, NoCounter&);
+template void smallSortNetwork<OperationCounter>(int*, int, OperationCounter&);
+
+
+
+template <class Counter>
+void simdQuickSortEngine(int* data, int n, Counter& counter) {  // AVX2 introsort; scalar introsort when AVX2 is missing
+    if (n <= 1) {
+        return;
+    }
+#ifdef SIMD_SORT_X86
+    if (cpuHasAvx2()) {
+        avx2IntroSortLoop(data, 0, n - 1, introSortDepthLimit(n), counter);
+        return;
+    }
+#endif
+    introSortLoop(data, 0, n - 1, introSortDepthLimit(n), counter);
+}
+
+template void simdQuickSortEngine<NoCounter>(int*, int, NoCounter&);
+template void simdQuickSortEngine<OperationCounter>(int*, int, OperationCounter&);
+
+
+
+SortResult simdQuickSort(vector<int>& arr) {  // SIMD quicksort driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    
+    simdQuickSortEngine(arr.data(), arr.size(), counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    
+    return SortResult("SIMD Quick Sort", counter.comparisons, timeMs, -1.0, counter.moves);
+}
@@ -0,0 +1,198 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <sys/stat.h>
+#include "../include/knn_predictor.h"
+#include "../include/external_sort.h"
+#include "../include/mapped_sort.h"
+#include "../include/corpus.h"
+
+using namespace std;
+
+
+
+void printUsage(const char* program) {  // Display command-line options
+    cout << "Usage: " << program << " <input.bin> [output.bin] [options]" << endl;
+    cout << "  Sorts a raw file of native-endian keys." << endl;
+    cout << "  Files that fit in the memory budget are sorted through mmap; larger int32 files externally." << endl;
+    cout << "  --type <type>      Key type: int32, int64, float or double (default: int32)" << endl;
+    cout << "  --in-place         Sort the input file itself (no output file)" << endl;
+    cout << "  --dry-run          Sort a private copy-on-write mapping; nothing is written" << endl;
+    cout << "  --external         Use the external sort even if the file fits in memory" << endl;
+    cout << "  --memory <MB>      Memory budget (default: 256)" << endl;
+    cout << "  --temp <dir>       Directory for sorted runs (default: /tmp)" << endl;
+    cout << "  --training <csv>   Training data for the predictor (default: built-in samples)" << endl;
+    cout << "  --capture <corpus> Append the int32 keys the predictor sees to a corpus for retraining" << endl;
+}
+
+bool finishCapture(const string& captureFile) {  // Write the corpus index; a failed capture only warns
+    if (!captureFile.empty() && !stopSortCapture()) {
+        cout << "[WARN] Capture to " << captureFile << " is incomplete." << endl;
+        return false;
+    }
+    return true;
+}
+
+struct CaptureSession {  // Stops the capture on every exit from main, so a failed run still leaves an indexed corpus
+    string captureFile;
+    
+    explicit CaptureSession(const string& file) : captureFile(file) {}
+    
+    ~CaptureSession() {
+        finishCapture(captureFile);
+    }
+};
+
+void displayMappedStats(const MappedSortStats& stats) {  // Display features, choice and per-phase timing
+    cout << "\n--- Mapped Sort Report ---" << endl;
+    cout << "  Elements:       " << stats.elements << endl;
+    cout << "  Sortedness:     " << fixed << setprecision(2) << stats.sortedness << "%";
+    if (stats.sortednessMargin > 0) {
+        cout << " +- " << stats.sortednessMargin << " (sampled)";
+    }
+    cout << endl;
+    cout << "  Unique Ratio:   " << fixed << setprecision(4) << stats.uniqueRatio;
+    if (stats.uniqueRatioMargin > 0) {
+        cout << " +- " << stats.uniqueRatioMargin << " (sampled)" << endl;
+    } else {
+        cout << " (estimated)" << endl;
+    }
+    cout << "  Algorithm:      " << stats.algorithm << endl;
+    
+    cout << "\n--- Phase Timing ---" << endl;
+    cout << "  Map:            " << fixed << setprecision(3) << stats.mapMs << " ms" << endl;
+    cout << "  Features:       " << fixed << setprecision(3) << stats.featureMs << " ms" << endl;
+    cout << "  Sort:           " << fixed << setprecision(3) << stats.sortMs << " ms" << endl;
+    cout << "  Sync:           " << fixed << setprecision(3) << stats.syncMs << " ms" << endl;
+}
+
+void displayExternalStats(const ExternalSortStats& stats) {  // Display per-phase I/O and timing
+    const double MB = 1024.0 * 1024.0;
+    
+    cout << "\n--- External Sort Report ---" << endl;
+    cout << "  Elements:       " << stats.elements << endl;
+    cout << "  Sorted runs:    " << stats.runCount << endl;
+    cout << "  Merge passes:   " << stats.mergePasses << endl;
+    cout << "  Bytes read:     " << stats.bytesRead << " (" << fixed << setprecision(1) << stats.bytesRead / MB << " MB)" << endl;
+    cout << "  Bytes written:  " << stats.bytesWritten << " (" << fixed << setprecision(1) << stats.bytesWritten / MB << " MB)" << endl;
+    
+    cout << "\n--- Phase Timing ---" << endl;
+    cout << "  Run phase:      " << fixed << setprecision(3) << stats.runPhaseMs << " ms" << endl;
+    cout << "    features:     " << fixed << setprecision(3) << stats.featureMs << " ms" << endl;
+    cout << "    sorting:      " << fixed << setprecision(3) << stats.sortMs << " ms" << endl;
+    cout << "  Merge phase:    " << fixed << setprecision(3) << stats.mergePhaseMs << " ms" << endl;
+    
+    cout << "\n--- Algorithms Chosen per Run ---" << endl;
+    for (const auto& pair : stats.algorithmRuns) {
+        cout << "  " << left << setw(16) << pair.first << right << pair.second << endl;
+    }
+}
+
+
+
+int main(int argc, char* argv[]) {  // Non-interactive file sort entry point
+    vector<string> files;
+    size_t memoryMB = 256;
+    string tempDir = "/tmp";
+    string trainingFile;
+    string captureFile;
+    bool inPlace = false, dryRun = false, external = false;
+    KeyType keyType = KEY_INT32;
+    
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--in-place") {
+            inPlace = true;
+        } else if (option == "--dry-run") {
+            dryRun = true;
+        } else if (option == "--external") {
+            external = true;
+        } else if (option == "--type" && i + 1 < argc) {
+            if (!parseKeyType(argv[++i], keyType) || keyType == KEY_STRING) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (option == "--memory" && i + 1 < argc) {
+            memoryMB = strtoul(argv[++i], nullptr, 10);
+        } else if (option == "--temp" && i + 1 < argc) {
+            tempDir = argv[++i];
+        } else if (option == "--training" && i + 1 < argc) {
+            trainingFile = argv[++i];
+        } else if (option == "--capture" && i + 1 < argc) {
+            captureFile = argv[++i];
+        } else if (option.compare(0, 2, "--") != 0) {
+            files.push_back(option);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    // Exactly one of: an output file, --in-place, --dry-run
+    bool needsOutput = !inPlace && !dryRun;
+    if (files.size() != (needsOutput ? 2u : 1u) || (inPlace && dryRun)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (memoryMB == 0) {
+        cout << "[ERROR] Memory budget must be at least 1 MB." << endl;
+        return 1;
+    }
+    
+    KNNPredictor predictor(5);
+    if (trainingFile.empty() || !predictor.loadTrainingDataFromFile(trainingFile)) {
+        if (!trainingFile.empty()) {
+            cout << "[WARN] Failed to load " << trainingFile << ". Using default training data." << endl;
+        }
+        predictor.loadDefaultTrainingData();
+    }
+    
+    if (!captureFile.empty() && !startSortCapture(captureFile)) {
+        cout << "[ERROR] cannot create " << captureFile << endl;
+        return 1;
+    }
+    CaptureSession capture(captureFile);
+    
+    size_t memoryBytes = memoryMB * 1024 * 1024;
+    struct stat info;
+    if (stat(files[0].c_str(), &info) != 0) {
+        cout << "[ERROR] cannot open " << files[0] << endl;
+        return 1;
+    }
+    
+    // A mapped file may use half the budget: merge, radix and Tim allocate as much again in scratch,
+    // the same split externalSort makes for its chunks
+    size_t mappedBytes = memoryBytes / 2;
+    
+    // The external sort only handles int32 keys; other types must fit in memory
+    if (keyType != KEY_INT32 && (external || (size_t)info.st_size > mappedBytes)) {
+        cout << "[ERROR] " << getKeyTypeName(keyType) << " files are sorted in memory only; raise --memory." << endl;
+        return 1;
+    }
+    
+    if (!external && (size_t)info.st_size <= mappedBytes) {
+        MappedSortMode mode = inPlace ? MAPPED_IN_PLACE : dryRun ? MAPPED_PRIVATE : MAPPED_TO_OUTPUT;
+        MappedSortStats stats;
+        if (!mappedSort(files[0], needsOutput ? files[1] : "", mode, predictor, stats, keyType)) {
+            cout << "[ERROR] " << stats.error << endl;
+            return 1;
+        }
+        displayMappedStats(stats);
+        return 0;
+    }
+    
+    if (!needsOutput) {
+        cout << "[ERROR] " << files[0] << " exceeds the memory budget; the external sort needs an output file." << endl;
+        return 1;
+    }
+    ExternalSortStats stats;
+    if (!externalSort(files[0], files[1], memoryBytes, tempDir, predictor, stats)) {
+        cout << "[ERROR] " << stats.error << endl;
+        return 1;
+    }
+    
+    displayExternalStats(stats);
+    return 0;
+}
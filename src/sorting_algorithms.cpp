@@ -1,4 +1,5 @@
 #include "../include/sorting_algorithms.h"
+#include "../include/simd_kernels.h"
 #include <chrono>
 #include <algorithm>
 
@@ -7,172 +8,750 @@ using namespace chrono;
 
 
 
-void merge(vector<int>& arr, int left, int mid, int right, long long& comparisons) {  // Merge two sorted subarrays
-    // Calculate sizes of two subarrays to be merged
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-    
-    // Create temporary arrays for left and right subarrays
-    vector<int> L(n1), R(n2);
-    
-    // Copy data to temporary arrays
-    for (int i = 0; i < n1; i++)
-        L[i] = arr[left + i];
-    for (int j = 0; j < n2; j++)
-        R[j] = arr[mid + 1 + j];
-    
-    // Merge the temporary arrays back into arr[left..right]
-    int i = 0, j = 0, k = left;
+const int MERGE_RUN_SIZE = 32;  // Runs up to this length are built with insertion sort
+
+
+
+template <class Counter>
+void insertionSortRange(int* data, int left, int right, Counter& counter) {  // Insertion sort on data[left..right]
+    for (int i = left + 1; i <= right; i++) {
+        int key = data[i];
+        int j = i - 1;
+        
+        while (j >= left) {
+            counter.compare();
+            if (data[j] > key) {
+                data[j + 1] = data[j];
+                counter.move();
+                j--;
+            } else {
+                break;
+            }
+        }
+        data[j + 1] = key;
+        counter.move();
+    }
+}
+
+template <class Counter>
+void mergeRuns(const int* src, int* dst, int left, int mid, int right, Counter& counter) {  // Merge src[left, mid) and src[mid, right) into dst
+    int i = left, j = mid, k = left;
     
-    // Compare elements from both arrays and place smaller one in result
-    while (i < n1 && j < n2) {
-        comparisons++;
-        if (L[i] <= R[j]) {
-            arr[k] = L[i];
-            i++;
+    // Compare heads of both runs and emit the smaller one (left wins ties for stability)
+    while (i < mid && j < right) {
+        counter.compare();
+        if (src[i] <= src[j]) {
+            dst[k++] = src[i++];
         } else {
-            arr[k] = R[j];
-            j++;
+            dst[k++] = src[j++];
         }
-        k++;
     }
     
-    // Copy any remaining elements from left array
-    while (i < n1) {
-        arr[k] = L[i];
-        i++;
-        k++;
+    // Copy whichever run still has elements
+    while (i < mid) {
+        dst[k++] = src[i++];
     }
-    
-    // Copy any remaining elements from right array
-    while (j < n2) {
-        arr[k] = R[j];
-        j++;
-        k++;
+    while (j < right) {
+        dst[k++] = src[j++];
     }
+    counter.move(right - left);
 }
 
-void mergeSortHelper(vector<int>& arr, int left, int right, long long& comparisons) {  // Recursive merge sort implementation
-    if (left < right) {
-        int mid = left + (right - left) / 2;
-        
-        mergeSortHelper(arr, left, mid, comparisons);
-        mergeSortHelper(arr, mid + 1, right, comparisons);
-        merge(arr, left, mid, right, comparisons);
+
+
+template <class Counter>
+void mergeSortRange(int* data, int* buffer, int n, Counter& counter) {  // Bottom-up merge sort of data[0, n)
+    // Build sorted runs of MERGE_RUN_SIZE in place with insertion sort
+    for (long long left = 0; left < n; left += MERGE_RUN_SIZE) {
+        int right = (int)min(left + MERGE_RUN_SIZE, (long long)n) - 1;
+        insertionSortRange(data, (int)left, right, counter);
+    }
+    
+    // Each pass doubles the run width and ping-pongs src <-> dst; 64-bit positions, as 2 * width passes 2^31 near INT_MAX
+    int* src = data;
+    int* dst = buffer;
+    for (long long width = MERGE_RUN_SIZE; width < n; width *= 2) {
+        for (long long left = 0; left < n; left += 2 * width) {
+            int mid = (int)min(left + width, (long long)n);
+            int right = (int)min(left + 2 * width, (long long)n);
+            mergeRuns(src, dst, (int)left, mid, right, counter);
+        }
+        swap(src, dst);
+    }
+    
+    // After an odd number of passes the result lives in the buffer
+    if (src != data) {
+        copy(src, src + n, data);
+        counter.move(n);
     }
 }
 
 
 
-int partition(vector<int>& arr, int low, int high, long long& comparisons) {  // Partition array for quicksort
-    int pivot = arr[high];  // Choose rightmost element as pivot
+const int QUICK_INSERTION_CUTOFF = 16;  // Partitions up to this size finish with insertion sort
+const int NINTHER_THRESHOLD = 128;      // Partitions above this size use Tukey's ninther pivot
+
+
+
+template <class Counter>
+void sortThree(int* data, int a, int b, int c, Counter& counter) {  // Order data[a] <= data[b] <= data[c]
+    counter.compare();
+    if (data[b] < data[a]) {
+        swap(data[a], data[b]);
+        counter.move(2);
+    }
+    counter.compare();
+    if (data[c] < data[b]) {
+        swap(data[b], data[c]);
+        counter.move(2);
+        counter.compare();
+        if (data[b] < data[a]) {
+            swap(data[a], data[b]);
+            counter.move(2);
+        }
+    }
+}
+
+template <class Counter>
+void choosePivot(int* data, int low, int high, Counter& counter) {  // Move median-of-three (or ninther) pivot to data[high]
+    int n = high - low + 1;
+    int mid = low + n / 2;
+    
+    if (n > NINTHER_THRESHOLD) {
+        // Tukey's ninther: median of the medians of three spread-out triples
+        int step = n / 8;
+        sortThree(data, low, low + step, low + 2 * step, counter);
+        sortThree(data, mid - step, mid, mid + step, counter);
+        sortThree(data, high - 2 * step, high - step, high, counter);
+        sortThree(data, low + step, mid, high - step, counter);
+    } else {
+        sortThree(data, low, mid, high, counter);
+    }
+    
+    swap(data[mid], data[high]);
+    counter.move(2);
+}
+
+template <class Counter>
+int partition(int* data, int low, int high, Counter& counter) {  // Lomuto partition around data[high]
+    int pivot = data[high];
     int i = low - 1;  // Index of smaller element
     
     // Move elements smaller than pivot to left side
     for (int j = low; j < high; j++) {
-        comparisons++;
-        if (arr[j] < pivot) {
+        counter.compare();
+        if (data[j] < pivot) {
             i++;
-            swap(arr[i], arr[j]);
+            swap(data[i], data[j]);
+            counter.move(2);
         }
     }
     // Place pivot in correct position
-    swap(arr[i + 1], arr[high]);
+    swap(data[i + 1], data[high]);
+    counter.move(2);
     return i + 1;
 }
 
-void quickSortHelper(vector<int>& arr, int low, int high, long long& comparisons) {  // Recursive quicksort implementation
-    if (low < high) {
-        int pi = partition(arr, low, high, comparisons);
-        quickSortHelper(arr, low, pi - 1, comparisons);
-        quickSortHelper(arr, pi + 1, high, comparisons);
+
+
+const int BLOCK_PARTITION_SIZE = 128;  // Keys classified per block; offsets fit in one byte
+
+
+
+template <class Counter>
+int blockPartition(int* data, int low, int high, Counter& counter) {  // BlockQuicksort partition around data[high]
+    int pivot = data[high];
+    unsigned char offsetsLeft[BLOCK_PARTITION_SIZE];
+    unsigned char offsetsRight[BLOCK_PARTITION_SIZE];
+    int startLeft = 0, countLeft = 0;
+    int startRight = 0, countRight = 0;
+    
+    // [low, l) < pivot and (r, high) >= pivot; blocks start at l and end at r
+    int l = low, r = high - 1;
+    while (r - l + 1 > 2 * BLOCK_PARTITION_SIZE) {
+        // Record misplaced keys without branching on the comparison: the offset is always
+        // written, the count only advances when the key belongs on the other side
+        if (countLeft == 0) {
+            startLeft = 0;
+            for (int i = 0; i < BLOCK_PARTITION_SIZE; i++) {
+                offsetsLeft[countLeft] = (unsigned char)i;
+                countLeft += !(data[l + i] < pivot);
+            }
+            counter.compare(BLOCK_PARTITION_SIZE);
+        }
+        if (countRight == 0) {
+            startRight = 0;
+            for (int i = 0; i < BLOCK_PARTITION_SIZE; i++) {
+                offsetsRight[countRight] = (unsigned char)i;
+                countRight += data[r - i] < pivot;
+            }
+            counter.compare(BLOCK_PARTITION_SIZE);
+        }
+        
+        // Swap misplaced pairs in bulk
+        int swaps = min(countLeft, countRight);
+        for (int j = 0; j < swaps; j++) {
+            swap(data[l + offsetsLeft[startLeft + j]], data[r - offsetsRight[startRight + j]]);
+        }
+        counter.move(2LL * swaps);
+        countLeft -= swaps;
+        countRight -= swaps;
+        startLeft += swaps;
+        startRight += swaps;
+        
+        // A block with no misplaced keys left is finished
+        if (countLeft == 0) l += BLOCK_PARTITION_SIZE;
+        if (countRight == 0) r -= BLOCK_PARTITION_SIZE;
+    }
+    
+    // At most three blocks remain unsettled; finish them with a plain Lomuto pass
+    int i = l - 1;
+    for (int j = l; j <= r; j++) {
+        counter.compare();
+        if (data[j] < pivot) {
+            i++;
+            swap(data[i], data[j]);
+            counter.move(2);
+        }
     }
+    swap(data[i + 1], data[high]);
+    counter.move(2);
+    return i + 1;
 }
 
 
 
-SortResult bubbleSort(vector<int>& arr) {  // Bubble sort with optimization
-    auto start = high_resolution_clock::now();
-    long long comparisons = 0;
+template <class Counter>
+void siftDown(int* data, int root, int size, Counter& counter) {  // Restore max-heap property below root
+    while (true) {
+        int child = 2 * root + 1;
+        if (child >= size) break;
+        
+        // Pick the larger child
+        if (child + 1 < size) {
+            counter.compare();
+            if (data[child] < data[child + 1]) child++;
+        }
+        
+        counter.compare();
+        if (!(data[root] < data[child])) break;
+        
+        swap(data[root], data[child]);
+        counter.move(2);
+        root = child;
+    }
+}
+
+template <class Counter>
+void heapSortRange(int* data, int low, int high, Counter& counter) {  // Heapsort on data[low..high], used as introsort fallback
+    int* heap = data + low;
+    int size = high - low + 1;
+    
+    for (int root = size / 2 - 1; root >= 0; root--) {
+        siftDown(heap, root, size, counter);
+    }
+    for (int end = size - 1; end > 0; end--) {
+        swap(heap[0], heap[end]);
+        counter.move(2);
+        siftDown(heap, 0, end, counter);
+    }
+}
+
+
+
+template <class Counter>
+void introSortLoop(int* data, int low, int high, int depthLimit, Counter& counter) {  // Introsort: quicksort with heapsort fallback
+    while (high - low + 1 > QUICK_INSERTION_CUTOFF) {
+        // Too many bad splits: switch to heapsort to guarantee O(n log n)
+        if (depthLimit == 0) {
+            heapSortRange(data, low, high, counter);
+            return;
+        }
+        depthLimit--;
+        
+        choosePivot(data, low, high, counter);
+        int pi = partition(data, low, high, counter);
+        
+        // Recurse into the smaller side and loop on the larger one, so stack depth stays O(log n)
+        if (pi - low < high - pi) {
+            introSortLoop(data, low, pi - 1, depthLimit, counter);
+            low = pi + 1;
+        } else {
+            introSortLoop(data, pi + 1, high, depthLimit, counter);
+            high = pi - 1;
+        }
+    }
+    
+    insertionSortRange(data, low, high, counter);
+}
+
+template <class Counter>
+void blockIntroSortLoop(int* data, int low, int high, int depthLimit, Counter& counter) {  // Introsort on the block partition
+    while (high - low + 1 > QUICK_INSERTION_CUTOFF) {
+        if (depthLimit == 0) {
+            heapSortRange(data, low, high, counter);
+            return;
+        }
+        depthLimit--;
+        
+        choosePivot(data, low, high, counter);
+        int pi = blockPartition(data, low, high, counter);
+        
+        if (pi - low < high - pi) {
+            blockIntroSortLoop(data, low, pi - 1, depthLimit, counter);
+            low = pi + 1;
+        } else {
+            blockIntroSortLoop(data, pi + 1, high, depthLimit, counter);
+            high = pi - 1;
+        }
+    }
+    
+    insertionSortRange(data, low, high, counter);
+}
+
+int introSortDepthLimit(int n) {  // 2 * floor(log2(n)), the classic introsort budget
+    int depth = 0;
+    while (n > 1) {
+        n >>= 1;
+        depth++;
+    }
+    return 2 * depth;
+}
+
+
+
+const int RADIX_BITS = 8;                      // Bits per LSD digit
+const int RADIX_BUCKETS = 1 << RADIX_BITS;
+const int RADIX_PASSES = 32 / RADIX_BITS;
+
+
+
+template <class Counter>
+void radixSortRange(int* data, int* buffer, int n, Counter& counter) {  // LSD radix sort of data[0, n) using buffer[0, n) as scratch
+    // Flipping the sign bit maps signed order onto unsigned order
+    const unsigned signFlip = 0x80000000u;
+    
+    // One pass over the data fills the histograms of every digit
+    vector<int> counts(RADIX_PASSES * RADIX_BUCKETS, 0);
+    for (int i = 0; i < n; i++) {
+        unsigned key = (unsigned)data[i] ^ signFlip;
+        for (int pass = 0; pass < RADIX_PASSES; pass++) {
+            counts[pass * RADIX_BUCKETS + ((key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++;
+        }
+    }
+    
+    int* src = data;
+    int* dst = buffer;
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+        int shift = pass * RADIX_BITS;
+        int* count = &counts[pass * RADIX_BUCKETS];
+        
+        // Every key has the same digit here: the pass would not move anything
+        unsigned firstDigit = (((unsigned)src[0] ^ signFlip) >> shift) & (RADIX_BUCKETS - 1);
+        if (count[firstDigit] == n) {
+            continue;
+        }
+        
+        // Turn counts into starting offsets
+        int offset = 0;
+        for (int b = 0; b < RADIX_BUCKETS; b++) {
+            int c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+        
+        // Stable scatter by the current digit
+        for (int i = 0; i < n; i++) {
+            unsigned digit = (((unsigned)src[i] ^ signFlip) >> shift) & (RADIX_BUCKETS - 1);
+            dst[count[digit]++] = src[i];
+        }
+        counter.move(n);
+        swap(src, dst);
+    }
+    
+    if (src != data) {
+        copy(src, src + n, data);
+        counter.move(n);
+    }
+}
+
+
+
+template <class Counter>
+void threeWayQuickSortLoop(int* data, int low, int high, int depthLimit, Counter& counter) {  // Quicksort with Dutch-national-flag partitioning
+    while (high - low + 1 > QUICK_INSERTION_CUTOFF) {
+        if (depthLimit == 0) {
+            heapSortRange(data, low, high, counter);
+            return;
+        }
+        depthLimit--;
+        
+        choosePivot(data, low, high, counter);
+        int pivot = data[high];
+        
+        // Invariant: [low, lt) < pivot, [lt, i) == pivot, (gt, high] > pivot
+        int lt = low, i = low, gt = high;
+        while (i <= gt) {
+            counter.compare();
+            if (data[i] < pivot) {
+                swap(data[lt++], data[i++]);
+                counter.move(2);
+            } else {
+                counter.compare();
+                if (pivot < data[i]) {
+                    swap(data[i], data[gt--]);
+                    counter.move(2);
+                } else {
+                    i++;
+                }
+            }
+        }
+        
+        // The whole run of keys equal to the pivot is final; only the outer parts remain
+        if (lt - low < high - gt) {
+            threeWayQuickSortLoop(data, low, lt - 1, depthLimit, counter);
+            low = gt + 1;
+        } else {
+            threeWayQuickSortLoop(data, gt + 1, high, depthLimit, counter);
+            high = lt - 1;
+        }
+    }
     
-    int n = arr.size();
+    insertionSortRange(data, low, high, counter);
+}
+
+
+
+const long long COUNTING_DENSE_SLACK = 1 << 16;              // Dense counting when range <= 2n + this
+const int HISTOGRAM_MAX_DISTINCT = 1024;                     // Sparse histogram path gives up beyond this many keys
+const int HISTOGRAM_TABLE_BITS = 12;
+const int HISTOGRAM_TABLE_SIZE = 1 << HISTOGRAM_TABLE_BITS;  // Open-addressing table, > 2x max distinct
+
+
+
+template <class Counter>
+bool histogramSort(int* data, int n, Counter& counter) {  // Sort via a small hash histogram; false if too many distinct keys
+    vector<int> keys(HISTOGRAM_TABLE_SIZE);
+    vector<int> counts(HISTOGRAM_TABLE_SIZE, 0);
+    int distinct = 0;
+    
+    for (int i = 0; i < n; i++) {
+        unsigned slot = hashSlot(data[i], HISTOGRAM_TABLE_BITS);
+        while (counts[slot] != 0 && keys[slot] != data[i]) {
+            slot = (slot + 1) & (HISTOGRAM_TABLE_SIZE - 1);
+        }
+        if (counts[slot] == 0) {
+            if (++distinct > HISTOGRAM_MAX_DISTINCT) {
+                return false;
+            }
+            keys[slot] = data[i];
+        }
+        counts[slot]++;
+    }
+    
+    // Sort the distinct keys, then write each one out as many times as it was seen
+    vector<int> distinctKeys;
+    distinctKeys.reserve(distinct);
+    for (int slot = 0; slot < HISTOGRAM_TABLE_SIZE; slot++) {
+        if (counts[slot] != 0) {
+            distinctKeys.push_back(keys[slot]);
+        }
+    }
+    quickSortEngine(distinctKeys.data(), distinct, counter);
+    
+    int k = 0;
+    for (int b = 0; b < distinct; b++) {
+        unsigned slot = hashSlot(distinctKeys[b], HISTOGRAM_TABLE_BITS);
+        while (counts[slot] == 0 || keys[slot] != distinctKeys[b]) {
+            slot = (slot + 1) & (HISTOGRAM_TABLE_SIZE - 1);
+        }
+        fill(data + k, data + k + counts[slot], distinctKeys[b]);
+        k += counts[slot];
+    }
+    counter.move(n);
+    return true;
+}
+
+
+
+template <class Counter>
+void bubbleSortEngine(int* data, int n, Counter& counter) {  // Bubble sort with optimization
     for (int i = 0; i < n - 1; i++) {
         bool swapped = false;  // Track if any swaps occurred
         // Compare adjacent elements and swap if needed
         for (int j = 0; j < n - i - 1; j++) {
-            comparisons++;
-            if (arr[j] > arr[j + 1]) {
-                swap(arr[j], arr[j + 1]);
+            counter.compare();
+            if (data[j] > data[j + 1]) {
+                swap(data[j], data[j + 1]);
+                counter.move(2);
                 swapped = true;
             }
         }
         // Early termination: if no swaps, array is sorted
         if (!swapped) break;
     }
-    
-    auto end = high_resolution_clock::now();
-    double timeMs = duration_cast<microseconds>(end - start).count() / 1000.0;
-    
-    return SortResult("Bubble Sort", comparisons, timeMs);
 }
 
+template <class Counter>
+void insertionSortEngine(int* data, int n, Counter& counter) {  // Insertion sort over the whole array
+    insertionSortRange(data, 0, n - 1, counter);
+}
+
+template <class Counter>
+void mergeSortEngine(int* data, int n, Counter& counter) {  // Bottom-up merge sort with one scratch buffer
+    if (n > 1) {
+        // Single scratch buffer for the whole sort (short arrays never touch it)
+        vector<int> buffer(n > MERGE_RUN_SIZE ? n : 0);
+        mergeSortRange(data, buffer.data(), n, counter);
+    }
+}
 
+template <class Counter>
+void quickSortEngine(int* data, int n, Counter& counter) {  // Introsort over the whole array
+    if (n > 1) {
+        introSortLoop(data, 0, n - 1, introSortDepthLimit(n), counter);
+    }
+}
 
-SortResult insertionSort(vector<int>& arr) {  // Insertion sort implementation
-    auto start = high_resolution_clock::now();
-    long long comparisons = 0;
+template <class Counter>
+void blockQuickSortEngine(int* data, int n, Counter& counter) {  // Block-partition introsort over the whole array
+    if (n > 1) {
+        blockIntroSortLoop(data, 0, n - 1, introSortDepthLimit(n), counter);
+    }
+}
+
+template <class Counter>
+void radixSortEngine(int* data, int n, Counter& counter) {  // LSD radix sort with one scratch buffer
+    if (n > 1) {
+        vector<int> buffer(n);
+        radixSortRange(data, buffer.data(), n, counter);
+    }
+}
+
+
+template <class Counter>
+void threeWayQuickSortEngine(int* data, int n, Counter& counter) {  // 3-way quicksort over the whole array
+    if (n > 1) {
+        threeWayQuickSortLoop(data, 0, n - 1, introSortDepthLimit(n), counter);
+    }
+}
+
+template <class Counter>
+void countingSortEngine(int* data, int n, Counter& counter) {  // Counting sort for small ranges, histogram for few distinct keys
+    if (n <= 1) {
+        return;
+    }
     
-    int n = arr.size();
+    int minValue = data[0], maxValue = data[0];
     for (int i = 1; i < n; i++) {
-        int key = arr[i];
-        int j = i - 1;
-        
-        while (j >= 0) {
-            comparisons++;
-            if (arr[j] > key) {
-                arr[j + 1] = arr[j];
-                j--;
-            } else {
-                break;
+        if (data[i] < minValue) minValue = data[i];
+        if (data[i] > maxValue) maxValue = data[i];
+    }
+    counter.compare(2LL * (n - 1));
+    
+    // Dense path: one counter per value in [min, max]
+    long long range = (long long)maxValue - minValue + 1;
+    if (range <= 2LL * n + COUNTING_DENSE_SLACK) {
+        vector<int> counts(range, 0);
+        for (int i = 0; i < n; i++) {
+            counts[(long long)data[i] - minValue]++;
+        }
+        int k = 0;
+        for (long long v = 0; v < range; v++) {
+            for (int c = counts[v]; c > 0; c--) {
+                data[k++] = (int)(minValue + v);
             }
         }
-        arr[j + 1] = key;
+        counter.move(n);
+        return;
     }
     
+    // Wide range but few distinct keys: sparse histogram; otherwise radix sort is the linear fallback
+    if (!histogramSort(data, n, counter)) {
+        radixSortEngine(data, n, counter);
+    }
+}
+
+
+#define INSTANTIATE_SORT_ENGINES(Counter) \
+    template void insertionSortRange<Counter>(int*, int, int, Counter&); \
+    template void mergeRuns<Counter>(const int*, int*, int, int, int, Counter&); \
+    template void mergeSortRange<Counter>(int*, int*, int, Counter&); \
+    template void choosePivot<Counter>(int*, int, int, Counter&); \
+    template int partition<Counter>(int*, int, int, Counter&); \
+    template void heapSortRange<Counter>(int*, int, int, Counter&); \
+    template void introSortLoop<Counter>(int*, int, int, int, Counter&); \
+    template void radixSortRange<Counter>(int*, int*, int, Counter&); \
+    template void bubbleSortEngine<Counter>(int*, int, Counter&); \
+    template void insertionSortEngine<Counter>(int*, int, Counter&); \
+    template void mergeSortEngine<Counter>(int*, int, Counter&); \
+    template void quickSortEngine<Counter>(int*, int, Counter&); \
+    template void blockQuickSortEngine<Counter>(int*, int, Counter&); \
+    template void radixSortEngine<Counter>(int*, int, Counter&); \
+    template void threeWayQuickSortEngine<Counter>(int*, int, Counter&); \
+    template void countingSortEngine<Counter>(int*, int, Counter&);
+
+INSTANTIATE_SORT_ENGINES(NoCounter)
+INSTANTIATE_SORT_ENGINES(OperationCounter)
+
+
+
+SortResult bubbleSort(vector<int>& arr) {  // Bubble sort driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    
+    bubbleSortEngine(arr.data(), arr.size(), counter);
+    
     auto end = high_resolution_clock::now();
-    double timeMs = duration_cast<microseconds>(end - start).count() / 1000.0;
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
     
-    return SortResult("Insertion Sort", comparisons, timeMs);
+    return SortResult("Bubble Sort", counter.comparisons, timeMs, -1.0, counter.moves);
+}
+
+
+
+SortResult insertionSort(vector<int>& arr) {  // Insertion sort driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    
+    insertionSortEngine(arr.data(), arr.size(), counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    
+    return SortResult("Insertion Sort", counter.comparisons, timeMs, -1.0, counter.moves);
 }
 
 
 
 SortResult mergeSort(vector<int>& arr) {  // Merge sort driver function
     auto start = high_resolution_clock::now();
-    long long comparisons = 0;
+    OperationCounter counter;
     
-    if (arr.size() > 1) {
-        mergeSortHelper(arr, 0, arr.size() - 1, comparisons);
-    }
+    mergeSortEngine(arr.data(), arr.size(), counter);
     
     auto end = high_resolution_clock::now();
-    double timeMs = duration_cast<microseconds>(end - start).count() / 1000.0;
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
     
-    return SortResult("Merge Sort", comparisons, timeMs);
+    return SortResult("Merge Sort", counter.comparisons, timeMs, -1.0, counter.moves);
 }
 
 
 
-SortResult quickSort(vector<int>& arr) {  // Quicksort driver function
+SortResult quickSort(vector<int>& arr) {  // Introsort driver function
     auto start = high_resolution_clock::now();
-    long long comparisons = 0;
+    OperationCounter counter;
     
-    if (arr.size() > 1) {
-        quickSortHelper(arr, 0, arr.size() - 1, comparisons);
-    }
+    quickSortEngine(arr.data(), arr.size(), counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    
+    return SortResult("Quick Sort", counter.comparisons, timeMs, -1.0, counter.moves);
+}
+
+
+
+SortResult blockQuickSort(vector<int>& arr) {  // BlockQuicksort driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    
+    blockQuickSortEngine(arr.data(), arr.size(), counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    
+    return SortResult("Block Quick Sort", counter.comparisons, timeMs, -1.0, counter.moves);
+}
+
+
+
+SortResult radixSort(vector<int>& arr) {  // LSD radix sort driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    
+    radixSortEngine(arr.data(), arr.size(), counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    
+    // Radix sort never compares keys, so only moves are counted
+    return SortResult("Radix Sort", counter.comparisons, timeMs, -1.0, counter.moves);
+}
+
+
+
+SortResult threeWayQuickSort(vector<int>& arr) {  // 3-way quicksort driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    
+    threeWayQuickSortEngine(arr.data(), arr.size(), counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    
+    return SortResult("3-Way Quick Sort", counter.comparisons, timeMs, -1.0, counter.moves);
+}
+
+
+
+SortResult countingSort(vector<int>& arr) {  // Counting sort driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    
+    countingSortEngine(arr.data(), arr.size(), counter);
     
     auto end = high_resolution_clock::now();
-    double timeMs = duration_cast<microseconds>(end - start).count() / 1000.0;
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
     
-    return SortResult("Quick Sort", comparisons, timeMs);
+    return SortResult("Counting Sort", counter.comparisons, timeMs, -1.0, counter.moves);
+}
+
+
+
+template <void (*Engine)(int*, int, NoCounter&)>
+void runUncounted(int* data, int n) {  // Registry kernel: run an engine with the no-op policy
+    NoCounter counter;
+    Engine(data, n, counter);
+}
+
+template <void (*Engine)(int*, int, int, NoCounter&)>
+void runUncountedOnAllCores(int* data, int n) {  // Registry kernel: run a parallel engine on every core
+    NoCounter counter;
+    Engine(data, n, 0, counter);
+}
+
+SortResult parallelMergeSortDefault(vector<int>& arr) {  // Registry entry: parallel merge sort on all cores
+    return parallelMergeSort(arr);
+}
+
+SortResult parallelQuickSortDefault(vector<int>& arr) {  // Registry entry: parallel quicksort on all cores
+    return parallelQuickSort(arr);
+}
+
+const vector<SortAlgorithm>& getSortAlgorithms() {  // Label, entry points and size range for every algorithm
+    static const vector<SortAlgorithm> algorithms = {
+        {"Bubble", bubbleSort, runUncounted<bubbleSortEngine<NoCounter> >, 0, 1000},
+        {"Insertion", insertionSort, runUncounted<insertionSortEngine<NoCounter> >, 0, 1000},
+        {"Merge", mergeSort, runUncounted<mergeSortEngine<NoCounter> >, 0, 0},
+        {"Quick", quickSort, runUncounted<quickSortEngine<NoCounter> >, 0, 0},
+        {"BlockQuick", blockQuickSort, runUncounted<blockQuickSortEngine<NoCounter> >, 0, 0},
+        {"SimdQuick", simdQuickSort, runUncounted<simdQuickSortEngine<NoCounter> >, 0, 0},
+        {"Radix", radixSort, runUncounted<radixSortEngine<NoCounter> >, 0, 0},
+        {"ThreeWayQuick", threeWayQuickSort, runUncounted<threeWayQuickSortEngine<NoCounter> >, 0, 0},
+        {"Counting", countingSort, runUncounted<countingSortEngine<NoCounter> >, 0, 0},
+        {"Tim", timSort, runUncounted<timSortEngine<NoCounter> >, 0, 0},
+        {"ParallelMerge", parallelMergeSortDefault, runUncountedOnAllCores<parallelMergeSortEngine<NoCounter> >, 8192, 0},
+        {"ParallelQuick", parallelQuickSortDefault, runUncountedOnAllCores<parallelQuickSortEngine<NoCounter> >, 8192, 0}
+    };
+    return algorithms;
+}
+
+const SortAlgorithm* findSortAlgorithm(const string& label) {  // Linear lookup, the list is tiny
+    for (const SortAlgorithm& algorithm : getSortAlgorithms()) {
+        if (algorithm.label == label) {
+            return &algorithm;
+        }
+    }
+    return nullptr;
 }
@@ -4,14 +4,17 @@
 #include <string>
 #include <map>
 #include <random>
+#include <cstdlib>
+#include <cmath>
 #include "../include/dataset.h"
 #include "../include/knn_predictor.h"
 #include "../include/sorting_algorithms.h"
+#include "../include/corpus.h"
+#include "../include/timing_harness.h"
 
 using namespace std;
 
-random_device rd;
-mt19937 gen(rd());
+Xoshiro256 gen;  // Sizes and per-array seeds; seeded in main so a failing run can be replayed
 
 // Test case structure
 struct TestCase {
@@ -20,7 +23,7 @@ struct TestCase {
     string datasetType;
 };
 
-// Generate 1000 test arrays (250 per type)
+// Generate 1000 test arrays (250 per classic type) plus 100 per registered workload
 vector<TestCase> generateTestCases() {  // Generate diverse test arrays
     vector<TestCase> testCases;
     
@@ -33,12 +36,8 @@ vector<TestCase> generateTestCases() {  // Generate diverse test arrays
     for (int i = 0; i < 250; i++) {
         TestCase tc;
         int size = (i < 125) ? smallSize(gen) : mediumSize(gen);
-        tc.array = generateRandom(size);
-        tc.features = Features(
-            getDatasetSize(tc.array),
-            calculateSortedness(tc.array),
-            calculateUniqueRatio(tc.array)
-        );
+        tc.array = generateRandom(size, gen());
+        tc.features = extractFeatures(tc.array);
         tc.datasetType = "Random";
         testCases.push_back(tc);
     }
@@ -48,12 +47,8 @@ vector<TestCase> generateTestCases() {  // Generate diverse test arrays
         TestCase tc;
         int size = (i < 25) ? smallSize(gen) : mediumSize(gen);
         int swaps = swapsDist(gen);
-        tc.array = generateNearlySorted(size, swaps);
-        tc.features = Features(
-            getDatasetSize(tc.array),
-            calculateSortedness(tc.array),
-            calculateUniqueRatio(tc.array)
-        );
+        tc.array = generateNearlySorted(size, swaps, gen());
+        tc.features = extractFeatures(tc.array);
         tc.datasetType = "Nearly Sorted";
         testCases.push_back(tc);
     }
@@ -63,11 +58,7 @@ vector<TestCase> generateTestCases() {  // Generate diverse test arrays
         TestCase tc;
         int size = (i < 25) ? smallSize(gen) : mediumSize(gen);
         tc.array = generateReversed(size);
-        tc.features = Features(
-            getDatasetSize(tc.array),
-            calculateSortedness(tc.array),
-            calculateUniqueRatio(tc.array)
-        );
+        tc.features = extractFeatures(tc.array);
         tc.datasetType = "Reversed";
         testCases.push_back(tc);
     }
@@ -77,56 +68,52 @@ vector<TestCase> generateTestCases() {  // Generate diverse test arrays
         TestCase tc;
         int size = (i < 25) ? smallSize(gen) : mediumSize(gen);
         int uniques = uniqueDist(gen);
-        tc.array = generateFewUnique(size, uniques);
-        tc.features = Features(
-            getDatasetSize(tc.array),
-            calculateSortedness(tc.array),
-            calculateUniqueRatio(tc.array)
-        );
+        tc.array = generateFewUnique(size, uniques, gen());
+        tc.features = extractFeatures(tc.array);
         tc.datasetType = "Few Unique";
         testCases.push_back(tc);
     }
     
+    // Registered workloads (100 each), parameter drawn log-uniformly from the registered range
+    uniform_real_distribution<> unit(0.0, 1.0);
+    for (const Workload& workload : getWorkloads()) {
+        for (int i = 0; i < 100; i++) {
+            TestCase tc;
+            int size = (i < 25) ? smallSize(gen) : mediumSize(gen);
+            double parameter = workload.minParameter * pow(workload.maxParameter / workload.minParameter, unit(gen));
+            tc.array = workload.generate(size, parameter, gen());
+            tc.features = extractFeatures(tc.array);
+            tc.datasetType = workload.label;
+            testCases.push_back(tc);
+        }
+    }
+    
     return testCases;
 }
 
-// Find actual best algorithm by testing
-string findActualBest(vector<int>& arr) {  // Test all algorithms and return fastest
-    vector<SortResult> results;
-    bool skipSlow = arr.size() > 1000;
-    
-    // Test algorithms (skip slow ones for large arrays)
-    if (!skipSlow) {
-        vector<int> arr1 = arr;
-        results.push_back(bubbleSort(arr1));
-        
-        vector<int> arr2 = arr;
-        results.push_back(insertionSort(arr2));
+// Captured production arrays instead of generated ones; the capture source is the dataset type
+bool loadCorpusTestCases(const string& corpusFile, vector<TestCase>& testCases) {  // Decode every record of a corpus
+    CorpusReader corpus;
+    if (!corpus.open(corpusFile)) {
+        cout << "[ERROR] " << corpus.getError() << endl;
+        return false;
     }
-    
-    vector<int> arr3 = arr;
-    results.push_back(mergeSort(arr3));
-    
-    vector<int> arr4 = arr;
-    results.push_back(quickSort(arr4));
-    
-    // Find fastest
-    string fastest = results[0].algorithmName;
-    double minTime = results[0].timeMs;
-    for (const auto& result : results) {
-        if (result.timeMs < minTime) {
-            minTime = result.timeMs;
-            fastest = result.algorithmName;
+    for (int i = 0; i < corpus.getRecordCount(); i++) {
+        TestCase tc;
+        if (!corpus.read(i, tc.array)) {
+            cout << "[WARN] Record " << i << " is corrupt; skipped" << endl;
+            continue;
         }
+        tc.features = extractFeatures(tc.array);
+        tc.datasetType = corpus.getSource(i).empty() ? "Captured" : corpus.getSource(i);
+        testCases.push_back(tc);
     }
-    
-    // Extract algorithm name without " Sort"
-    size_t pos = fastest.find(" Sort");
-    if (pos != string::npos) {
-        fastest = fastest.substr(0, pos);
-    }
-    
-    return fastest;
+    return true;
+}
+
+// Find actual best algorithm by racing; algorithms the race could not separate from it also count as correct
+RaceOutcome findActualBest(const vector<int>& arr) {  // Race all algorithms until the winner separates
+    return raceSortAlgorithms(arr);
 }
 
 // Test k-NN accuracy with given predictor
@@ -136,12 +123,16 @@ void testAccuracy(KNNPredictor& predictor, const string& testName, const vector<
     cout << "========================================" << endl;
     
     int correct = 0;
+    int ties = 0;
     map<string, map<string, int>> confusionMatrix;
     map<string, int> correctByType;
     map<string, int> totalByType;
     
     // Initialize confusion matrix
-    vector<string> algorithms = {"Bubble", "Insertion", "Merge", "Quick"};
+    vector<string> algorithms;
+    for (const SortAlgorithm& algorithm : getSortAlgorithms()) {
+        algorithms.push_back(algorithm.label);
+    }
     for (const auto& actual : algorithms) {
         for (const auto& pred : algorithms) {
             confusionMatrix[actual][pred] = 0;
@@ -154,10 +145,15 @@ void testAccuracy(KNNPredictor& predictor, const string& testName, const vector<
     
     for (const auto& tc : testCases) {
         string predicted = predictor.predict(tc.features);
-        string actual = findActualBest(const_cast<vector<int>&>(tc.array));
+        RaceOutcome race = findActualBest(tc.array);
+        string actual = race.winner;
+        if (race.isTie()) {
+            ties++;
+        }
         
         // Update counters
-        if (predicted == actual) {
+        if (race.accepts(predicted)) {
+            actual = predicted;  // A tie the predictor landed on is on the diagonal
             correct++;
             correctByType[tc.datasetType]++;
         }
@@ -177,6 +173,7 @@ void testAccuracy(KNNPredictor& predictor, const string& testName, const vector<
     cout << "Overall Results" << endl;
     cout << "----------------------------------------" << endl;
     cout << "Correct predictions: " << correct << "/" << testCases.size() << endl;
+    cout << "Ties (several algorithms within noise): " << ties << endl;
     cout << "Accuracy: " << fixed << setprecision(1) 
          << (100.0 * correct / testCases.size()) << "%" << endl;
     
@@ -200,39 +197,57 @@ void testAccuracy(KNNPredictor& predictor, const string& testName, const vector<
     cout << "              Predicted Algorithm" << endl;
     cout << "         ";
     for (const auto& algo : algorithms) {
-        cout << setw(10) << algo;
+        cout << setw(14) << algo;
     }
     cout << endl;
     
     for (const auto& actual : algorithms) {
         cout << "Actual " << setw(10) << left << actual;
         for (const auto& pred : algorithms) {
-            cout << setw(10) << right << confusionMatrix[actual][pred];
+            cout << setw(14) << right << confusionMatrix[actual][pred];
         }
         cout << endl;
     }
 }
 
-int main() {  // Test k-NN accuracy with built-in and external data
+int main(int argc, char* argv[]) {  // Test k-NN accuracy with built-in and external data; [seed] or --replay <corpus>
+    bool replay = argc > 2 && string(argv[1]) == "--replay";
+    uint64_t seed = argc > 1 && !replay ? strtoull(argv[1], nullptr, 10) : freshSeed();
+    gen = Xoshiro256(seed);
+    
     cout << "========================================" << endl;
     cout << "  k-NN Prediction Accuracy Test" << endl;
     cout << "========================================" << endl;
     
-    // Generate test cases
-    cout << "\nGenerating 1000 test arrays..." << endl;
-    cout << "  - Random: 250" << endl;
-    cout << "  - Nearly Sorted: 250" << endl;
-    cout << "  - Reversed: 250" << endl;
-    cout << "  - Few Unique: 250" << endl;
-    
-    vector<TestCase> testCases = generateTestCases();
-    cout << "\nGenerated " << testCases.size() << " test arrays successfully." << endl;
+    vector<TestCase> testCases;
+    if (replay) {
+        cout << "\nReplaying captured arrays from " << argv[2] << "..." << endl;
+        if (!loadCorpusTestCases(argv[2], testCases)) {
+            return 1;
+        }
+        cout << "\nLoaded " << testCases.size() << " captured arrays successfully." << endl;
+    } else {
+        cout << "Seed: " << seed << endl;
+        
+        // Generate test cases
+        cout << "\nGenerating " << 1000 + 100 * getWorkloads().size() << " test arrays..." << endl;
+        cout << "  - Random: 250" << endl;
+        cout << "  - Nearly Sorted: 250" << endl;
+        cout << "  - Reversed: 250" << endl;
+        cout << "  - Few Unique: 250" << endl;
+        for (const Workload& workload : getWorkloads()) {
+            cout << "  - " << workload.label << ": 100" << endl;
+        }
+        
+        testCases = generateTestCases();
+        cout << "\nGenerated " << testCases.size() << " test arrays successfully." << endl;
+    }
     
-    // Test 1: Built-in training data (26 samples)
+    // Test 1: Built-in training data (47 samples)
     KNNPredictor knn1(5);
     knn1.loadDefaultTrainingData();
     cout << "\nLoaded built-in training data: " << knn1.getTrainingDataSize() << " samples" << endl;
-    testAccuracy(knn1, "Built-in Training Data (26 samples)", testCases);
+    testAccuracy(knn1, "Built-in Training Data (47 samples)", testCases);
     
     // Test 2: External training data from CSV
     KNNPredictor knn2(5);
@@ -0,0 +1,174 @@
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <ctime>
+#include <pthread.h>
+
+using namespace std;
+
+
+
+static thread_local const ThreadPool* workerPool = nullptr;  // Pool the current thread works for
+static thread_local int workerIndex = 0;                     // Queue index of the current worker thread
+
+
+
+ThreadPool::ThreadPool(int threads) : queuedTasks(0), stopping(false) {  // Start threads - 1 workers; the caller is the last thread
+    if (threads <= 0) {
+        threads = max(1, (int)thread::hardware_concurrency());
+    }
+    threadCount = threads;
+    
+    for (int i = 0; i < threadCount; i++) {
+        queues.push_back(unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    for (int i = 1; i < threadCount; i++) {
+        workers.push_back(thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {  // Drain remaining work, then stop workers
+    while (runPendingTask()) {
+    }
+    
+    {
+        lock_guard<mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+
+
+int ThreadPool::getThreadCount() const {  // Workers plus the calling thread
+    return threadCount;
+}
+
+long long ThreadPool::workerCpuNs() {  // Sum of the workers' per-thread CPU clocks
+    long long total = 0;
+    for (thread& worker : workers) {
+        clockid_t clock;
+        timespec used;
+        if (pthread_getcpuclockid(worker.native_handle(), &clock) == 0 && clock_gettime(clock, &used) == 0) {
+            total += used.tv_sec * 1000000000LL + used.tv_nsec;
+        }
+    }
+    return total;
+}
+
+int ThreadPool::currentQueueIndex() const {  // Workers push to their own deque, everyone else shares queue 0
+    return (workerPool == this) ? workerIndex : 0;
+}
+
+void ThreadPool::submit(const function<void()>& task) {  // Push to the back of the caller's deque and wake a sleeper
+    WorkQueue& queue = *queues[currentQueueIndex()];
+    {
+        lock_guard<mutex> guard(queue.lock);
+        queue.tasks.push_back(task);
+    }
+    
+    {
+        lock_guard<mutex> guard(sleepLock);
+        queuedTasks++;
+    }
+    wakeUp.notify_one();
+}
+
+bool ThreadPool::popTask(int index, function<void()>& task) {  // LIFO from own deque, FIFO steal from the others
+    {
+        WorkQueue& own = *queues[index];
+        lock_guard<mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = move(own.tasks.back());
+            own.tasks.pop_back();
+            queuedTasks--;
+            return true;
+        }
+    }
+    
+    // Steal the oldest task of another queue: it is usually the largest piece of work
+    for (int offset = 1; offset < threadCount; offset++) {
+        WorkQueue& victim = *queues[(index + offset) % threadCount];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queuedTasks--;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+bool ThreadPool::runPendingTask() {  // Let a waiting thread help instead of blocking
+    function<void()> task;
+    if (!popTask(currentQueueIndex(), task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(int index) {  // Worker main loop: run tasks, sleep when every queue is empty
+    workerPool = this;
+    workerIndex = index;
+    
+    while (true) {
+        function<void()> task;
+        if (popTask(index, task)) {
+            task();
+            continue;
+        }
+        
+        unique_lock<mutex> guard(sleepLock);
+        wakeUp.wait(guard, [this] { return stopping || queuedTasks > 0; });
+        if (stopping && queuedTasks == 0) {
+            return;
+        }
+    }
+}
+
+
+
+TaskGroup::TaskGroup(ThreadPool& threadPool) : pool(threadPool), pending(0) {}
+
+TaskGroup::~TaskGroup() {  // Never leave forked tasks referencing a dead scope
+    join();
+}
+
+void TaskGroup::run(const function<void()>& task) {  // Fork: count the task, always finish by decrementing
+    pending++;
+    pool.submit([this, task] {
+        try {
+            task();
+        } catch (...) {
+            lock_guard<mutex> guard(failureLock);
+            if (!failure) {
+                failure = current_exception();
+            }
+        }
+        pending--;
+    });
+}
+
+void TaskGroup::join() {  // Help run queued tasks while children are still pending
+    while (pending > 0) {
+        if (!pool.runPendingTask()) {
+            this_thread::yield();
+        }
+    }
+}
+
+void TaskGroup::wait() {  // Join, then surface a task's exception (e.g. bad_alloc of a merge buffer) to the forking thread
+    join();
+    lock_guard<mutex> guard(failureLock);
+    if (failure) {
+        exception_ptr thrown = failure;
+        failure = nullptr;
+        rethrow_exception(thrown);
+    }
+}
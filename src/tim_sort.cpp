@@ -0,0 +1,445 @@
+#include "../include/sorting_algorithms.h"
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+using namespace chrono;
+
+
+
+const int TIM_MIN_MERGE = 32;   // Arrays shorter than this are one binary insertion sort
+const int TIM_MIN_GALLOP = 7;   // Consecutive wins by one run before switching to galloping
+
+
+
+template <class Counter>
+class TimSorter {  // Natural-run merge sort state: the array, its run stack and one scratch buffer
+private:
+    int* a;
+    int n;
+    Counter& counter;
+    vector<int> tmp;        // Scratch for the smaller run of a merge, allocated once on first merge
+    vector<int> runBase;    // Pending runs, bottom of the stack first
+    vector<int> runLen;
+    int minGallop;
+
+    static int minRunLength(int length) {  // Run length so that n / minRun is close to a power of two
+        int r = 0;
+        while (length >= TIM_MIN_MERGE) {
+            r |= length & 1;
+            length >>= 1;
+        }
+        return length + r;
+    }
+
+    int countRunAndMakeAscending(int lo, int hi) {  // Length of the run at lo; strictly descending runs are reversed
+        int runHi = lo + 1;
+        if (runHi == hi) return 1;
+
+        counter.compare();
+        if (a[runHi++] < a[lo]) {
+            while (runHi < hi) {
+                counter.compare();
+                if (!(a[runHi] < a[runHi - 1])) break;
+                runHi++;
+            }
+            reverse(a + lo, a + runHi);
+            counter.move(runHi - lo);
+        } else {
+            while (runHi < hi) {
+                counter.compare();
+                if (a[runHi] < a[runHi - 1]) break;
+                runHi++;
+            }
+        }
+        return runHi - lo;
+    }
+
+    void binaryInsertionSort(int lo, int hi, int start) {  // Extend the sorted prefix a[lo, start) to a[lo, hi)
+        for (; start < hi; start++) {
+            int pivot = a[start];
+            int left = lo, right = start;
+            while (left < right) {
+                int mid = (left + right) >> 1;
+                counter.compare();
+                if (pivot < a[mid]) right = mid;
+                else left = mid + 1;
+            }
+            memmove(a + left + 1, a + left, (start - left) * sizeof(int));
+            a[left] = pivot;
+            counter.move(start - left + 1);
+        }
+    }
+
+    int gallopLeft(int key, const int* base, int len, int hint) {  // Leftmost insertion point of key in base[0, len)
+        int lastOfs = 0, ofs = 1;
+        counter.compare();
+        if (key > base[hint]) {
+            // Gallop right until base[hint + lastOfs] < key <= base[hint + ofs]
+            int maxOfs = len - hint;
+            while (ofs < maxOfs) {
+                counter.compare();
+                if (!(key > base[hint + ofs])) break;
+                lastOfs = ofs;
+                ofs = (ofs << 1) + 1;
+                if (ofs <= 0) ofs = maxOfs;
+            }
+            if (ofs > maxOfs) ofs = maxOfs;
+            lastOfs += hint;
+            ofs += hint;
+        } else {
+            // Gallop left until base[hint - ofs] < key <= base[hint - lastOfs]
+            int maxOfs = hint + 1;
+            while (ofs < maxOfs) {
+                counter.compare();
+                if (key > base[hint - ofs]) break;
+                lastOfs = ofs;
+                ofs = (ofs << 1) + 1;
+                if (ofs <= 0) ofs = maxOfs;
+            }
+            if (ofs > maxOfs) ofs = maxOfs;
+            int t = lastOfs;
+            lastOfs = hint - ofs;
+            ofs = hint - t;
+        }
+
+        // Binary search in (lastOfs, ofs]
+        lastOfs++;
+        while (lastOfs < ofs) {
+            int m = lastOfs + ((ofs - lastOfs) >> 1);
+            counter.compare();
+            if (key > base[m]) lastOfs = m + 1;
+            else ofs = m;
+        }
+        return ofs;
+    }
+
+    int gallopRight(int key, const int* base, int len, int hint) {  // Rightmost insertion point of key in base[0, len)
+        int lastOfs = 0, ofs = 1;
+        counter.compare();
+        if (key < base[hint]) {
+            // Gallop left until base[hint - ofs] <= key < base[hint - lastOfs]
+            int maxOfs = hint + 1;
+            while (ofs < maxOfs) {
+                counter.compare();
+                if (!(key < base[hint - ofs])) break;
+                lastOfs = ofs;
+                ofs = (ofs << 1) + 1;
+                if (ofs <= 0) ofs = maxOfs;
+            }
+            if (ofs > maxOfs) ofs = maxOfs;
+            int t = lastOfs;
+            lastOfs = hint - ofs;
+            ofs = hint - t;
+        } else {
+            // Gallop right until base[hint + lastOfs] <= key < base[hint + ofs]
+            int maxOfs = len - hint;
+            while (ofs < maxOfs) {
+                counter.compare();
+                if (key < base[hint + ofs]) break;
+                lastOfs = ofs;
+                ofs = (ofs << 1) + 1;
+                if (ofs <= 0) ofs = maxOfs;
+            }
+            if (ofs > maxOfs) ofs = maxOfs;
+            lastOfs += hint;
+            ofs += hint;
+        }
+
+        lastOfs++;
+        while (lastOfs < ofs) {
+            int m = lastOfs + ((ofs - lastOfs) >> 1);
+            counter.compare();
+            if (key < base[m]) ofs = m;
+            else lastOfs = m + 1;
+        }
+        return ofs;
+    }
+
+    void mergeLo(int base1, int len1, int base2, int len2) {  // Merge left to right; run 1 (the shorter) goes to tmp
+        memcpy(tmp.data(), a + base1, len1 * sizeof(int));
+        counter.move(len1);
+        int* t = tmp.data();
+        int cursor1 = 0, cursor2 = base2, dest = base1;
+
+        a[dest++] = a[cursor2++];
+        counter.move();
+        if (--len2 == 0) {
+            memcpy(a + dest, t + cursor1, len1 * sizeof(int));
+            counter.move(len1);
+            return;
+        }
+        if (len1 == 1) {
+            memmove(a + dest, a + cursor2, len2 * sizeof(int));
+            a[dest + len2] = t[cursor1];
+            counter.move(len2 + 1);
+            return;
+        }
+
+        int gallop = minGallop;
+        while (true) {
+            int count1 = 0, count2 = 0;  // Consecutive wins of each run
+
+            // One element at a time until one run keeps winning
+            bool done = false;
+            do {
+                counter.compare();
+                counter.move();
+                if (a[cursor2] < t[cursor1]) {
+                    a[dest++] = a[cursor2++];
+                    count2++;
+                    count1 = 0;
+                    if (--len2 == 0) { done = true; break; }
+                } else {
+                    a[dest++] = t[cursor1++];
+                    count1++;
+                    count2 = 0;
+                    if (--len1 == 1) { done = true; break; }
+                }
+            } while ((count1 | count2) < gallop);
+            if (done) break;
+
+            // Galloping: copy whole blocks found by exponential search
+            do {
+                count1 = gallopRight(a[cursor2], t + cursor1, len1, 0);
+                if (count1 != 0) {
+                    memcpy(a + dest, t + cursor1, count1 * sizeof(int));
+                    counter.move(count1);
+                    dest += count1;
+                    cursor1 += count1;
+                    len1 -= count1;
+                    if (len1 <= 1) { done = true; break; }
+                }
+                a[dest++] = a[cursor2++];
+                counter.move();
+                if (--len2 == 0) { done = true; break; }
+
+                count2 = gallopLeft(t[cursor1], a + cursor2, len2, 0);
+                if (count2 != 0) {
+                    memmove(a + dest, a + cursor2, count2 * sizeof(int));
+                    counter.move(count2);
+                    dest += count2;
+                    cursor2 += count2;
+                    len2 -= count2;
+                    if (len2 == 0) { done = true; break; }
+                }
+                a[dest++] = t[cursor1++];
+                counter.move();
+                if (--len1 == 1) { done = true; break; }
+                gallop--;
+            } while (count1 >= TIM_MIN_GALLOP || count2 >= TIM_MIN_GALLOP);
+            if (done) break;
+
+            // Leaving gallop mode costs more next time
+            if (gallop < 0) gallop = 0;
+            gallop += 2;
+        }
+        minGallop = gallop < 1 ? 1 : gallop;
+
+        if (len1 == 1) {
+            memmove(a + dest, a + cursor2, len2 * sizeof(int));
+            a[dest + len2] = t[cursor1];
+            counter.move(len2 + 1);
+        } else {
+            memcpy(a + dest, t + cursor1, len1 * sizeof(int));
+            counter.move(len1);
+        }
+    }
+
+    void mergeHi(int base1, int len1, int base2, int len2) {  // Merge right to left; run 2 (the shorter) goes to tmp
+        memcpy(tmp.data(), a + base2, len2 * sizeof(int));
+        counter.move(len2);
+        int* t = tmp.data();
+        int cursor1 = base1 + len1 - 1, cursor2 = len2 - 1, dest = base2 + len2 - 1;
+
+        a[dest--] = a[cursor1--];
+        counter.move();
+        if (--len1 == 0) {
+            memcpy(a + dest - (len2 - 1), t, len2 * sizeof(int));
+            counter.move(len2);
+            return;
+        }
+        if (len2 == 1) {
+            dest -= len1;
+            cursor1 -= len1;
+            memmove(a + dest + 1, a + cursor1 + 1, len1 * sizeof(int));
+            a[dest] = t[cursor2];
+            counter.move(len1 + 1);
+            return;
+        }
+
+        int gallop = minGallop;
+        while (true) {
+            int count1 = 0, count2 = 0;
+
+            bool done = false;
+            do {
+                counter.compare();
+                counter.move();
+                if (t[cursor2] < a[cursor1]) {
+                    a[dest--] = a[cursor1--];
+                    count1++;
+                    count2 = 0;
+                    if (--len1 == 0) { done = true; break; }
+                } else {
+                    a[dest--] = t[cursor2--];
+                    count2++;
+                    count1 = 0;
+                    if (--len2 == 1) { done = true; break; }
+                }
+            } while ((count1 | count2) < gallop);
+            if (done) break;
+
+            do {
+                count1 = len1 - gallopRight(t[cursor2], a + base1, len1, len1 - 1);
+                if (count1 != 0) {
+                    dest -= count1;
+                    cursor1 -= count1;
+                    len1 -= count1;
+                    memmove(a + dest + 1, a + cursor1 + 1, count1 * sizeof(int));
+                    counter.move(count1);
+                    if (len1 == 0) { done = true; break; }
+                }
+                a[dest--] = t[cursor2--];
+                counter.move();
+                if (--len2 == 1) { done = true; break; }
+
+                count2 = len2 - gallopLeft(a[cursor1], t, len2, len2 - 1);
+                if (count2 != 0) {
+                    dest -= count2;
+                    cursor2 -= count2;
+                    len2 -= count2;
+                    memcpy(a + dest + 1, t + cursor2 + 1, count2 * sizeof(int));
+                    counter.move(count2);
+                    if (len2 <= 1) { done = true; break; }
+                }
+                a[dest--] = a[cursor1--];
+                counter.move();
+                if (--len1 == 0) { done = true; break; }
+                gallop--;
+            } while (count1 >= TIM_MIN_GALLOP || count2 >= TIM_MIN_GALLOP);
+            if (done) break;
+
+            if (gallop < 0) gallop = 0;
+            gallop += 2;
+        }
+        minGallop = gallop < 1 ? 1 : gallop;
+
+        if (len2 == 1) {
+            dest -= len1;
+            cursor1 -= len1;
+            memmove(a + dest + 1, a + cursor1 + 1, len1 * sizeof(int));
+            a[dest] = t[cursor2];
+            counter.move(len1 + 1);
+        } else {
+            memcpy(a + dest - (len2 - 1), t, len2 * sizeof(int));
+            counter.move(len2);
+        }
+    }
+
+    void mergeAt(int i) {  // Merge pending runs i and i + 1
+        int base1 = runBase[i], len1 = runLen[i];
+        int base2 = runBase[i + 1], len2 = runLen[i + 1];
+
+        runLen[i] = len1 + len2;
+        runBase.erase(runBase.begin() + i + 1);
+        runLen.erase(runLen.begin() + i + 1);
+
+        // Elements of run 1 already below run 2's head stay where they are
+        int k = gallopRight(a[base2], a + base1, len1, 0);
+        base1 += k;
+        len1 -= k;
+        if (len1 == 0) return;
+
+        // Elements of run 2 already above run 1's tail stay where they are
+        len2 = gallopLeft(a[base1 + len1 - 1], a + base2, len2, len2 - 1);
+        if (len2 == 0) return;
+
+        if (tmp.empty()) {
+            tmp.resize(n / 2 + 1);  // No merge ever copies more than the shorter half
+        }
+        if (len1 <= len2) mergeLo(base1, len1, base2, len2);
+        else mergeHi(base1, len1, base2, len2);
+    }
+
+    void mergeCollapse() {  // Merge until run lengths shrink geometrically down the stack
+        while (runLen.size() > 1) {
+            int i = runLen.size() - 2;
+            if ((i > 0 && runLen[i - 1] <= runLen[i] + runLen[i + 1]) ||
+                (i > 1 && runLen[i - 2] <= runLen[i - 1] + runLen[i])) {
+                if (runLen[i - 1] < runLen[i + 1]) i--;
+            } else if (runLen[i] > runLen[i + 1]) {
+                break;
+            }
+            mergeAt(i);
+        }
+    }
+
+    void mergeForceCollapse() {  // Merge everything that is left
+        while (runLen.size() > 1) {
+            int i = runLen.size() - 2;
+            if (i > 0 && runLen[i - 1] < runLen[i + 1]) i--;
+            mergeAt(i);
+        }
+    }
+
+public:
+    TimSorter(int* data, int length, Counter& c)
+        : a(data), n(length), counter(c), minGallop(TIM_MIN_GALLOP) {}
+
+    void sort() {  // Find runs, extend short ones, push them and keep the stack balanced
+        if (n < 2) return;
+
+        if (n < TIM_MIN_MERGE) {
+            int initRunLen = countRunAndMakeAscending(0, n);
+            binaryInsertionSort(0, n, initRunLen);
+            return;
+        }
+
+        int minRun = minRunLength(n);
+        int lo = 0, remaining = n;
+        do {
+            int len = countRunAndMakeAscending(lo, n);
+            if (len < minRun) {
+                int force = min(remaining, minRun);
+                binaryInsertionSort(lo, lo + force, lo + len);
+                len = force;
+            }
+
+            runBase.push_back(lo);
+            runLen.push_back(len);
+            mergeCollapse();
+
+            lo += len;
+            remaining -= len;
+        } while (remaining != 0);
+
+        mergeForceCollapse();
+    }
+};
+
+
+
+template <class Counter>
+void timSortEngine(int* data, int n, Counter& counter) {  // Adaptive natural-run merge sort
+    TimSorter<Counter> sorter(data, n, counter);
+    sorter.sort();
+}
+
+template void timSortEngine<NoCounter>(int*, int, NoCounter&);
+template void timSortEngine<OperationCounter>(int*, int, OperationCounter&);
+
+
+
+SortResult timSort(vector<int>& arr) {  // TimSort driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+
+    timSortEngine(arr.data(), arr.size(), counter);
+
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+
+    return SortResult("Tim Sort", counter.comparisons, timeMs, -1.0, counter.moves);
+}
@@ -0,0 +1,149 @@
+#include "../include/timing_harness.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+using namespace std;
+
+
+
+long long monotonicNs() {  // Monotonic, unaffected by NTP steps, nanosecond resolution
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+
+
+static void summarize(const vector<double>& samplesNs, double z, KernelTiming& timing) {  // Median, MAD and the median's interval
+    vector<double> sorted = samplesNs;
+    sort(sorted.begin(), sorted.end());
+    int m = sorted.size();
+    double median = m % 2 ? sorted[m / 2] : (sorted[m / 2 - 1] + sorted[m / 2]) / 2;
+    
+    vector<double> deviations(m);
+    for (int i = 0; i < m; i++) {
+        deviations[i] = fabs(sorted[i] - median);
+    }
+    sort(deviations.begin(), deviations.end());
+    double mad = m % 2 ? deviations[m / 2] : (deviations[m / 2 - 1] + deviations[m / 2]) / 2;
+    
+    // Ranks m/2 -+ z*sqrt(m)/2 bracket the median with the requested confidence, whatever the distribution
+    double halfWidth = z * sqrt((double)m) / 2;
+    int low = max(0, (int)floor(m / 2.0 - halfWidth));
+    int high = min(m - 1, (int)ceil(m / 2.0 + halfWidth) - 1);
+    
+    timing.medianMs = median / 1e6;
+    timing.madMs = mad / 1e6;
+    timing.lowMs = sorted[low] / 1e6;
+    timing.highMs = sorted[high] / 1e6;
+    timing.trials = m;
+}
+
+template <class Key>
+static double timeSample(const vector<Key>& input, const TimedKernel<Key>& kernel, vector<vector<Key> >& scratch,
+                         int copies) {  // Nanoseconds per sort over copies fresh inputs; the copying is not timed
+    scratch.resize(copies);
+    for (int c = 0; c < copies; c++) {
+        scratch[c] = input;
+    }
+    long long start = monotonicNs();
+    for (int c = 0; c < copies; c++) {
+        kernel.run(scratch[c]);
+    }
+    return (double)(monotonicNs() - start) / copies;
+}
+
+
+
+template <class Key>
+RaceOutcome raceKernels(const vector<Key>& input, const vector<TimedKernel<Key> >& candidates,
+                        const TimingConfig& config) {  // Batches until the leader's interval clears every rival's
+    RaceOutcome outcome;
+    int count = candidates.size();
+    if (count == 0) {
+        return outcome;
+    }
+    outcome.timings.resize(count);
+    vector<vector<double> > samples(count);
+    vector<bool> active(count, true);
+    vector<vector<Key> > scratch;
+    long long n = max((size_t)1, input.size());
+    
+    // Warm up; the last warmup also sizes the batch so one sample is well above the clock's resolution
+    for (int c = 0; c < count; c++) {
+        outcome.timings[c].label = candidates[c].label;
+        double singleNs = 1;
+        for (int w = 0; w < max(1, config.warmups); w++) {
+            singleNs = timeSample(input, candidates[c], scratch, 1);
+        }
+        long long copies = (long long)ceil(config.minSampleNs / max(singleNs, 1.0));
+        outcome.timings[c].copies = (int)max(1LL, min(copies, config.maxBatchKeys / n));
+    }
+    
+    int leader = 0;
+    for (int trials = 0; trials < config.maxTrials; ) {
+        // Round-robin inside the batch, so drift (frequency, noisy neighbours) hits every candidate alike
+        for (int t = 0; t < config.batchTrials; t++) {
+            for (int c = 0; c < count; c++) {
+                if (active[c]) {
+                    samples[c].push_back(timeSample(input, candidates[c], scratch, outcome.timings[c].copies));
+                }
+            }
+        }
+        trials += config.batchTrials;
+    
+        leader = -1;
+        for (int c = 0; c < count; c++) {
+            if (!active[c]) continue;
+            summarize(samples[c], config.confidenceZ, outcome.timings[c]);
+            if (leader < 0 || outcome.timings[c].medianMs < outcome.timings[leader].medianMs) {
+                leader = c;
+            }
+        }
+        bool contested = false;
+        for (int c = 0; c < count; c++) {
+            if (!active[c] || c == leader) continue;
+            if (outcome.timings[c].lowMs > outcome.timings[leader].highMs) {
+                active[c] = false;  // Separated: slower with confidence
+            } else {
+                contested = true;
+            }
+        }
+        if (!contested) break;
+    }
+    
+    outcome.winner = candidates[leader].label;
+    for (int c = 0; c < count; c++) {
+        if (active[c] && c != leader) {
+            outcome.tiedWith.push_back(candidates[c].label);
+        }
+    }
+    return outcome;
+}
+
+template RaceOutcome raceKernels<int>(const vector<int>&, const vector<TimedKernel<int> >&, const TimingConfig&);
+template RaceOutcome raceKernels<long long>(const vector<long long>&, const vector<TimedKernel<long long> >&, const TimingConfig&);
+template RaceOutcome raceKernels<float>(const vector<float>&, const vector<TimedKernel<float> >&, const TimingConfig&);
+template RaceOutcome raceKernels<double>(const vector<double>&, const vector<TimedKernel<double> >&, const TimingConfig&);
+template RaceOutcome raceKernels<string>(const vector<string>&, const vector<TimedKernel<string> >&, const TimingConfig&);
+
+
+
+RaceOutcome raceSortAlgorithms(const vector<int>& input, bool singleThreadedOnly, const TimingConfig& config) {  // Registry kernels, no counters
+    vector<TimedKernel<int> > candidates;
+    for (const SortAlgorithm& algorithm : getSortAlgorithms()) {
+        if (!algorithm.appliesTo(input.size())) {
+            continue;
+        }
+        if (singleThreadedOnly && algorithm.label.compare(0, 8, "Parallel") == 0) {
+            continue;  // The fork-join kernels need every core
+        }
+        SortKernel kernel = algorithm.kernel;
+        TimedKernel<int> candidate;
+        candidate.label = algorithm.label;
+        candidate.run = [kernel](vector<int>& keys) { kernel(keys.data(), keys.size()); };
+        candidates.push_back(candidate);
+    }
+    return raceKernels(input, candidates, config);
+}
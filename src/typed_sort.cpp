@@ -0,0 +1,177 @@
+#include "../include/typed_sort.h"
+#include "../include/dataset.h"
+#include "../include/keyed_sort.h"
+#include <chrono>
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+using namespace chrono;
+
+
+
+const int TYPED_FEATURE_SAMPLE_SIZE = 4096; // Keys sampled for the unique ratio
+
+
+
+template <> KeyType keyTypeOf<long long>() { return KEY_INT64; }
+template <> KeyType keyTypeOf<float>() { return KEY_FLOAT; }
+template <> KeyType keyTypeOf<double>() { return KEY_DOUBLE; }
+template <> KeyType keyTypeOf<string>() { return KEY_STRING; }
+
+vector<string> getTypedSortLabels(KeyType type) {  // One label per distinct engine; aliases are left out
+    if (type == KEY_STRING) {
+        return {"Insertion", "Merge", "Quick", "MultikeyQuick"};
+    }
+    return {"Insertion", "Merge", "Quick", "Radix"};
+}
+
+
+
+static inline int charAt(const string& s, int depth) {  // Byte at depth, or -1 past the end so shorter strings sort first
+    return depth < (int)s.size() ? (unsigned char)s[depth] : -1;
+}
+
+template <class Counter>
+void suffixInsertionSort(string* data, int low, int high, int depth, Counter& counter) {  // Keys already agree on their first depth bytes
+    for (int i = low + 1; i <= high; i++) {
+        string item = move(data[i]);
+        int j = i - 1;
+        
+        while (j >= low) {
+            counter.compare();
+            if (data[j].compare(depth, string::npos, item, depth, string::npos) > 0) {
+                data[j + 1] = move(data[j]);
+                counter.move();
+                j--;
+            } else {
+                break;
+            }
+        }
+        data[j + 1] = move(item);
+        counter.move();
+    }
+}
+
+template <class Counter>
+void multikeyQuickSort(string* data, int low, int high, int depth, Counter& counter) {  // Bentley-Sedgewick three-way radix quicksort
+    while (high - low + 1 > KEYED_INSERTION_CUTOFF) {
+        // Median-of-three pivot byte at the current depth
+        int a = charAt(data[low], depth);
+        int b = charAt(data[low + (high - low) / 2], depth);
+        int c = charAt(data[high], depth);
+        int pivot = max(min(a, b), min(max(a, b), c));
+        
+        // Partition on one byte: shared prefixes are never compared again
+        int lt = low, i = low, gt = high;
+        while (i <= gt) {
+            int ch = charAt(data[i], depth);
+            counter.compare();
+            if (ch < pivot) {
+                swap(data[lt++], data[i++]);
+                counter.move(2);
+            } else if (ch > pivot) {
+                swap(data[i], data[gt--]);
+                counter.move(2);
+            } else {
+                i++;
+            }
+        }
+        
+        multikeyQuickSort(data, low, lt - 1, depth, counter);
+        multikeyQuickSort(data, gt + 1, high, depth, counter);
+        
+        // Equal bytes: continue one byte deeper, unless every key here has ended
+        if (pivot < 0) {
+            return;
+        }
+        low = lt;
+        high = gt;
+        depth++;
+    }
+    
+    if (low < high) {
+        suffixInsertionSort(data, low, high, depth, counter);
+    }
+}
+
+template <class Key, class Counter>
+void typedRadixSort(Key* data, int n, Counter& counter) {  // LSD radix on KeyTraits::orderedBits
+    keyedRadixSort(data, n, IdentityKey<Key>(), counter);
+}
+
+template <class Counter>
+void typedRadixSort(string* data, int n, Counter& counter) {  // Strings have no fixed-width image; radix means multikey quicksort
+    multikeyQuickSort(data, 0, n - 1, 0, counter);
+}
+
+
+
+static string typedEngineLabel(const string& label) {  // Map a registry label onto the engines this key type has
+    if (label == "Insertion" || label == "Bubble") return "Insertion";
+    if (label == "Merge" || label == "Tim" || label == "ParallelMerge") return "Merge";
+    if (label == "Radix" || label == "Counting" || label == "MultikeyQuick") return "Radix";
+    return "Quick";
+}
+
+template <class Key, class Counter>
+string typedSortEngine(Key* data, int n, const string& label, Counter& counter) {  // Run the engine for a label, return its name
+    string engine = typedEngineLabel(label);
+    string name = string(getKeyTypeName(keyTypeOf<Key>())) + " ";
+    
+    if (engine == "Insertion") {
+        keyedInsertionSort(data, 0, n - 1, IdentityKey<Key>(), counter);
+        return name + "Insertion Sort";
+    }
+    if (engine == "Merge") {
+        keyedMergeSort(data, n, IdentityKey<Key>(), counter);
+        return name + "Merge Sort";
+    }
+    if (engine == "Radix") {
+        if (n > 1) typedRadixSort(data, n, counter);
+        return name + (keyTypeOf<Key>() == KEY_STRING ? "Multikey Quick Sort" : "Radix Sort");
+    }
+    if (n > 1) keyedIntroSortLoop(data, 0, n - 1, introSortDepthLimit(n), IdentityKey<Key>(), counter);
+    return name + "Quick Sort";
+}
+
+template <class Key>
+void typedSortKernel(Key* data, int n, const string& label) {  // Uninstrumented, for buffers that are not vectors
+    NoCounter counter;
+    typedSortEngine(data, n, label, counter);
+}
+
+template <class Key>
+SortResult sortTypedKeys(vector<Key>& keys, const string& label) {  // Counted driver function
+    auto start = high_resolution_clock::now();
+    OperationCounter counter;
+    
+    string name = typedSortEngine(keys.data(), keys.size(), label, counter);
+    
+    auto end = high_resolution_clock::now();
+    double timeMs = duration_cast<nanoseconds>(end - start).count() / 1e6;
+    
+    return SortResult(name, counter.comparisons, timeMs, -1.0, counter.moves);
+}
+
+template <class Key>
+SortResult sortTypedKeys(vector<Key>& keys, KNNPredictor& predictor) {  // Predict from typed features, then sort
+    const Key* data = keys.data();
+    int n = keys.size();
+    Features features(n, calculateSortedness(data, n), sampleUniqueRatio(data, n, TYPED_FEATURE_SAMPLE_SIZE),
+                      keyTypeOf<Key>());
+    return sortTypedKeys(keys, predictor.predict(features));
+}
+
+template void typedSortKernel<long long>(long long*, int, const string&);
+template void typedSortKernel<float>(float*, int, const string&);
+template void typedSortKernel<double>(double*, int, const string&);
+template void typedSortKernel<string>(string*, int, const string&);
+template SortResult sortTypedKeys<long long>(vector<long long>&, const string&);
+template SortResult sortTypedKeys<float>(vector<float>&, const string&);
+template SortResult sortTypedKeys<double>(vector<double>&, const string&);
+template SortResult sortTypedKeys<string>(vector<string>&, const string&);
+template SortResult sortTypedKeys<long long>(vector<long long>&, KNNPredictor&);
+template SortResult sortTypedKeys<float>(vector<float>&, KNNPredictor&);
+template SortResult sortTypedKeys<double>(vector<double>&, KNNPredictor&);
+template SortResult sortTypedKeys<string>(vector<string>&, KNNPredictor&);